@@ -0,0 +1,318 @@
+// deterministic rendering benchmark of the fixed and float casters
+//
+// Replays camera paths frame by frame and times the phases of every frame
+// separately: tracing the columns, filling them with sky, walls and floor,
+// and drawing the HUD overlay of RenderGame. Results are printed as JSON.
+//
+// With --views N every frame of a path is rendered from N viewpoints in one
+// batch, the view of the path turned by multiples of 360 / N degrees. The
+// phase timings are then per batch, while fps and column_ns count every
+// view.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "camera_path.h"
+#include "game.h"
+#include "map.h"
+#include "raycaster.h"
+#include "raycaster_fixed.h"
+#include "raycaster_float.h"
+#include "renderer.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point from, Clock::time_point to)
+{
+    return chrono::duration<double>(to - from).count();
+}
+
+// a JSON string literal of s, quotes included
+static string JsonString(const char *s)
+{
+    string json = "\"";
+    for (; *s != '\0'; s++) {
+        const unsigned char c = *s;
+        if (c == '"' || c == '\\') {
+            json += '\\';
+            json += c;
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            json += escaped;
+        } else {
+            json += c;
+        }
+    }
+    return json + "\"";
+}
+
+// nearest-rank percentile of sorted samples
+static double Percentile(const vector<double> &sorted, double p)
+{
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[min(rank, sorted.size()) - 1];
+}
+
+// print timing statistics of a phase in milliseconds
+static void PrintStats(const char *name, vector<double> samples, bool last)
+{
+    double sum = 0;
+    for (double s : samples) {
+        sum += s;
+    }
+    sort(samples.begin(), samples.end());
+    printf(
+        "        \"%s\": {\"mean\": %.6f, \"p50\": %.6f, \"p99\": %.6f, "
+        "\"max\": %.6f}%s\n",
+        name, 1e3 * sum / samples.size(), 1e3 * Percentile(samples, 0.5),
+        1e3 * Percentile(samples, 0.99), 1e3 * samples.back(),
+        last ? "" : ",");
+}
+
+// fov of zero selects the default of the caster
+static RayCaster *CreateCaster(const string &name,
+                               int width,
+                               int height,
+                               double fov,
+                               const Map &map)
+{
+    if (name == "fixed") {
+        return new RayCasterFixed(width, height, fov > 0 ? fov : FIXED_FOV_X,
+                                  map);
+    } else if (name == "float") {
+        return new RayCasterFloat(width, height, fov > 0 ? fov : FOV_X, map);
+    }
+    return NULL;
+}
+
+static void Usage(const char *name)
+{
+    printf(
+        "Usage: %s [options]\n"
+        "  -c, --caster fixed|float  caster to measure, may be repeated "
+        "(both)\n"
+        "  -p, --path FILE           camera path script, may be repeated "
+        "(built-in path)\n"
+        "  -M, --map FILE            world map (built-in map)\n"
+        "  -r, --repeat N            replay every path N times (3)\n"
+        "  -w, --warmup N            untimed frames before each run (30)\n"
+        "  -t, --threads N           rendering threads (1)\n"
+        "  -v, --views N             viewpoints rendered per batch (1)\n"
+        "  -W, --width N             screen width (%d)\n"
+        "  -H, --height N            screen height (%d)\n"
+        "  -f, --fov DEGREES         horizontal field of view (caster "
+        "default)\n"
+        "  -m, --column-major        render columns contiguously, then "
+        "transpose\n"
+        "      --no-mipmaps          sample walls at full texture size\n"
+        "  -F, --floor               texture the floor and ceiling\n",
+        name, SCREEN_WIDTH, SCREEN_HEIGHT);
+}
+
+int main(int argc, char *args[])
+{
+    vector<string> casters;
+    vector<string> pathFiles;
+    const char *mapFile = NULL;
+    int repeat = 3;
+    int warmup = 30;
+    int threads = 1;
+    int viewCount = 1;
+    bool columnMajor = false;
+    bool mipmaps = true;
+    bool texturedFloor = false;
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+    double fov = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = args[i];
+        const char *value = i + 1 < argc ? args[i + 1] : NULL;
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            Usage(args[0]);
+            return 0;
+        } else if (!strcmp(arg, "-m") || !strcmp(arg, "--column-major")) {
+            columnMajor = true;
+            continue;
+        } else if (!strcmp(arg, "--no-mipmaps")) {
+            mipmaps = false;
+            continue;
+        } else if (!strcmp(arg, "-F") || !strcmp(arg, "--floor")) {
+            texturedFloor = true;
+            continue;
+        } else if (value == NULL) {
+            Usage(args[0]);
+            return 1;
+        } else if (!strcmp(arg, "-c") || !strcmp(arg, "--caster")) {
+            casters.push_back(value);
+        } else if (!strcmp(arg, "-p") || !strcmp(arg, "--path")) {
+            pathFiles.push_back(value);
+        } else if (!strcmp(arg, "-M") || !strcmp(arg, "--map")) {
+            mapFile = value;
+        } else if (!strcmp(arg, "-r") || !strcmp(arg, "--repeat")) {
+            repeat = max(1, atoi(value));
+        } else if (!strcmp(arg, "-w") || !strcmp(arg, "--warmup")) {
+            warmup = max(0, atoi(value));
+        } else if (!strcmp(arg, "-t") || !strcmp(arg, "--threads")) {
+            threads = atoi(value);
+        } else if (!strcmp(arg, "-v") || !strcmp(arg, "--views")) {
+            viewCount = max(1, atoi(value));
+        } else if (!strcmp(arg, "-W") || !strcmp(arg, "--width")) {
+            width = atoi(value);
+        } else if (!strcmp(arg, "-H") || !strcmp(arg, "--height")) {
+            height = atoi(value);
+        } else if (!strcmp(arg, "-f") || !strcmp(arg, "--fov")) {
+            fov = atof(value) * M_PI / 180;
+        } else {
+            Usage(args[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (width < MIN_SCREEN_SIZE || width > MAX_SCREEN_SIZE ||
+        height < MIN_SCREEN_SIZE || height > MAX_SCREEN_SIZE) {
+        fprintf(stderr, "Resolution must be within %dx%d and %dx%d\n",
+                MIN_SCREEN_SIZE, MIN_SCREEN_SIZE, MAX_SCREEN_SIZE,
+                MAX_SCREEN_SIZE);
+        return 1;
+    }
+    if (fov < 0 || fov >= M_PI) {
+        fprintf(stderr, "Field of view must be below 180 degrees\n");
+        return 1;
+    }
+    if (casters.empty()) {
+        casters.push_back("fixed");
+        casters.push_back("float");
+    }
+
+    Map map;
+    if (mapFile != NULL && !map.Load(mapFile)) {
+        return 1;
+    }
+
+    vector<CameraPath> paths(max<size_t>(1, pathFiles.size()));
+    for (size_t i = 0; i < pathFiles.size(); i++) {
+        if (!paths[i].Load(pathFiles[i].c_str())) {
+            return 1;
+        }
+    }
+
+    vector<vector<uint32_t>> frameBuffers(viewCount,
+                                          vector<uint32_t>(width * height));
+    vector<uint32_t *> fbs;
+    for (vector<uint32_t> &frameBuffer : frameBuffers) {
+        fbs.push_back(frameBuffer.data());
+    }
+    vector<Viewpoint> views(viewCount);
+    bool firstRun = true;
+    printf("{\n  \"width\": %d,\n  \"height\": %d,\n", width, height);
+    printf("  \"map\": %s,\n  \"runs\": [",
+           JsonString(mapFile != NULL ? mapFile : "default").c_str());
+
+    for (const string &casterName : casters) {
+        unique_ptr<RayCaster> caster(
+            CreateCaster(casterName, width, height, fov, map));
+        if (!caster) {
+            fprintf(stderr, "Unknown caster %s\n", casterName.c_str());
+            return 1;
+        }
+        Renderer renderer(caster.get(), threads);
+        renderer.SetColumnMajor(columnMajor);
+        renderer.SetMipmaps(mipmaps);
+        renderer.SetTexturedFloor(texturedFloor);
+
+        for (size_t p = 0; p < paths.size(); p++) {
+            const CameraPath &path = paths[p];
+            vector<double> frame, trace, fill, hud;
+
+            for (int r = -1; r < repeat; r++) {
+                // the first pass only warms up caches and the worker pool
+                const int frames = r < 0 ? min(warmup, path.Frames())
+                                         : path.Frames();
+                Game game(map);
+                for (int f = 0; f < frames; f++) {
+                    path.Apply(f, &game);
+                    // the phases cannot be told apart in see-through mode
+                    game.godMode = 0;
+                    for (int v = 0; v < viewCount; v++) {
+                        views[v] = {game.playerX, game.playerY,
+                                    game.playerA +
+                                        2 * static_cast<float>(M_PI) * v /
+                                            viewCount};
+                    }
+
+                    const auto t0 = Clock::now();
+                    renderer.TraceHits(views.data(), viewCount);
+                    const auto t1 = Clock::now();
+                    renderer.FillFrames(&game, fbs.data(), viewCount);
+                    const auto t2 = Clock::now();
+                    for (uint32_t *fb : fbs) {
+                        renderer.RenderGame(&game, fb);
+                    }
+                    const auto t3 = Clock::now();
+
+                    if (r >= 0) {
+                        trace.push_back(Seconds(t0, t1));
+                        fill.push_back(Seconds(t1, t2));
+                        hud.push_back(Seconds(t2, t3));
+                        frame.push_back(Seconds(t0, t3));
+                    }
+                }
+            }
+            if (frame.empty()) {
+                continue;
+            }
+
+            double total = 0, traceTotal = 0, fillTotal = 0;
+            for (size_t i = 0; i < frame.size(); i++) {
+                total += frame[i];
+                traceTotal += trace[i];
+                fillTotal += fill[i];
+            }
+            const double frames =
+                static_cast<double>(frame.size()) * viewCount;
+            const double columns = frames * width;
+
+            printf("%s\n    {\n", firstRun ? "" : ",");
+            printf("      \"caster\": %s,\n",
+                   JsonString(casterName.c_str()).c_str());
+            printf("      \"path\": %s,\n",
+                   JsonString(pathFiles.empty() ? "default"
+                                                : pathFiles[p].c_str())
+                       .c_str());
+            printf("      \"threads\": %d,\n", renderer.GetThreadCount());
+            printf("      \"views\": %d,\n", viewCount);
+            printf("      \"column_major\": %s,\n",
+                   columnMajor ? "true" : "false");
+            printf("      \"mipmaps\": %s,\n", mipmaps ? "true" : "false");
+            printf("      \"textured_floor\": %s,\n",
+                   texturedFloor ? "true" : "false");
+            printf("      \"frames\": %.0f,\n", frames);
+            printf("      \"fps\": %.2f,\n", frames / total);
+            printf(
+                "      \"column_ns\": {\"trace\": %.2f, \"fill\": %.2f},\n",
+                1e9 * traceTotal / columns, 1e9 * fillTotal / columns);
+            printf("      \"ms\": {\n");
+            PrintStats("frame", frame, false);
+            PrintStats("trace", trace, false);
+            PrintStats("fill", fill, false);
+            PrintStats("hud", hud, true);
+            printf("      }\n    }");
+            firstRun = false;
+        }
+    }
+    printf("\n  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "billboards.h"
+#include <math.h>
+#include <algorithm>
+
+Billboards::Billboards(const Map &map)
+    : _bucketsX((map.Width() + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS),
+      _bucketsY((map.Height() + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS)
+{
+    _buckets.assign(_bucketsX * _bucketsY, -1);
+}
+
+int Billboards::Bucket(float x, float y) const
+{
+    const int bx = static_cast<int>(floorf(x)) >> MAP_BLOCK_BITS;
+    const int by = static_cast<int>(floorf(y)) >> MAP_BLOCK_BITS;
+    return std::min(std::max(by, 0), _bucketsY - 1) * _bucketsX +
+           std::min(std::max(bx, 0), _bucketsX - 1);
+}
+
+int Billboards::Add(float x, float y, uint8_t texture)
+{
+    const int id = Size();
+    const int bucket = Bucket(x, y);
+    _items.push_back({x, y, texture});
+    _next.push_back(_buckets[bucket]);
+    _buckets[bucket] = id;
+    return id;
+}
+
+void Billboards::Unlink(int id)
+{
+    int *link = &_buckets[Bucket(_items[id].x, _items[id].y)];
+    while (*link != id) {
+        link = &_next[*link];
+    }
+    *link = _next[id];
+}
+
+void Billboards::Move(int id, float x, float y)
+{
+    const int bucket = Bucket(x, y);
+    if (bucket != Bucket(_items[id].x, _items[id].y)) {
+        Unlink(id);
+        _next[id] = _buckets[bucket];
+        _buckets[bucket] = id;
+    }
+    _items[id].x = x;
+    _items[id].y = y;
+}
+
+void Billboards::Cull(float x,
+                      float y,
+                      float leftX,
+                      float leftY,
+                      float rightX,
+                      float rightY,
+                      float depth,
+                      std::vector<int> *ids) const
+{
+    // bounding box of the triangle, grown by the half cell a billboard
+    // reaches out of its bucket
+    const float farLeftX = x + leftX * depth;
+    const float farLeftY = y + leftY * depth;
+    const float farRightX = x + rightX * depth;
+    const float farRightY = y + rightY * depth;
+    const float minX = std::min({x, farLeftX, farRightX}) - 0.5f;
+    const float maxX = std::max({x, farLeftX, farRightX}) + 0.5f;
+    const float minY = std::min({y, farLeftY, farRightY}) - 0.5f;
+    const float maxY = std::max({y, farLeftY, farRightY}) + 0.5f;
+
+    const int first = Bucket(minX, minY);
+    const int last = Bucket(maxX, maxY);
+    const int firstX = first % _bucketsX;
+    const int lastX = last % _bucketsX;
+    for (int row = first - firstX; row <= last - lastX; row += _bucketsX) {
+        for (int bucket = row + firstX; bucket <= row + lastX; bucket++) {
+            for (int id = _buckets[bucket]; id >= 0; id = _next[id]) {
+                ids->push_back(id);
+            }
+        }
+    }
+}
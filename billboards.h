@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "map.h"
+
+// An object of the world drawn as a picture that always faces the viewer,
+// one cell wide and as tall as a wall, standing on the floor at its center
+struct Billboard {
+    float x;
+    float y;
+    uint8_t texture;  // wall texture, its black texels are transparent
+};
+
+// Billboards of a map, kept in buckets of MAP_BLOCK_SIZE x MAP_BLOCK_SIZE
+// cells so that a view only looks at the buckets it can see, however many
+// billboards the rest of the map holds. Billboards off the map are kept in
+// the nearest bucket.
+class Billboards
+{
+public:
+    // Add a billboard and return its id
+    int Add(float x, float y, uint8_t texture);
+    void Move(int id, float x, float y);
+    const Billboard &Get(int id) const { return _items[id]; }
+    int Size() const { return static_cast<int>(_items.size()); }
+
+    // Append to ids the billboards in the buckets the view triangle from
+    // (x, y), `depth` cells deep and spanning (leftX, leftY) to (rightX,
+    // rightY) at a depth of one cell, may reach
+    void Cull(float x,
+              float y,
+              float leftX,
+              float leftY,
+              float rightX,
+              float rightY,
+              float depth,
+              std::vector<int> *ids) const;
+
+    explicit Billboards(const Map &map = Map::Default());
+
+private:
+    std::vector<Billboard> _items;
+    std::vector<int> _next;     // next billboard of the same bucket, or -1
+    std::vector<int> _buckets;  // first billboard of every bucket, or -1
+    int _bucketsX;
+    int _bucketsY;
+
+    int Bucket(float x, float y) const;
+    void Unlink(int id);
+};
@@ -0,0 +1,142 @@
+#include "camera_path.h"
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+
+// rotate in place, walk around and look through walls for a while
+const char *CameraPath::DefaultScript =
+    "at 23.03 6.8 5.25\n"
+    "move 0 1 120\n"
+    "move 1 0 90\n"
+    "move 1 -1 60\n"
+    "move 0 -1 60\n"
+    "god 1\n"
+    "move 0 1 60\n"
+    "god 0\n"
+    "pose squat\n"
+    "move -1 0 60\n"
+    "pose stand\n"
+    "move 1 1 90\n";
+
+bool CameraPath::Parse(const std::string &script)
+{
+    std::istringstream lines(script);
+    std::string line;
+    Frame state = {false, 0, 0, 0, 0, 0, 0, POSE_STAND};
+    int lineNo = 0;
+
+    _frames.clear();
+    _billboards.clear();
+    _scatters.clear();
+    while (std::getline(lines, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream args(line);
+        std::string command;
+        if (!(args >> command)) {
+            continue;
+        }
+
+        bool ok = true;
+        if (command == "at") {
+            ok = static_cast<bool>(args >> state.x >> state.y >> state.a);
+            state.place = true;
+        } else if (command == "move") {
+            int frames = 0;
+            ok = static_cast<bool>(args >> state.move >> state.rotate >>
+                                   frames) &&
+                 frames >= 0;
+            for (int i = 0; i < frames; i++) {
+                _frames.push_back(state);
+                state.place = false;
+            }
+        } else if (command == "god") {
+            ok = static_cast<bool>(args >> state.godMode);
+        } else if (command == "billboard") {
+            Billboard b;
+            int texture = 0;
+            ok = static_cast<bool>(args >> b.x >> b.y >> texture) &&
+                 texture >= 0 && texture <= UINT8_MAX;
+            b.texture = static_cast<uint8_t>(texture);
+            _billboards.push_back(b);
+        } else if (command == "scatter") {
+            int count = 0;
+            int texture = 0;
+            ok = static_cast<bool>(args >> count >> texture) && count >= 0 &&
+                 texture >= 0 && texture <= UINT8_MAX;
+            _scatters.push_back({count, static_cast<uint8_t>(texture)});
+        } else if (command == "pose") {
+            std::string pose;
+            ok = static_cast<bool>(args >> pose);
+            if (pose == "stand") {
+                state.pose = POSE_STAND;
+            } else if (pose == "squat") {
+                state.pose = POSE_SQUAT;
+            } else {
+                ok = false;
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "camera path:%d: invalid command '%s'\n", lineNo,
+                    line.c_str());
+            _frames.clear();
+            _billboards.clear();
+            _scatters.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CameraPath::Load(const char *fileName)
+{
+    std::ifstream file(fileName);
+    if (!file) {
+        fprintf(stderr, "Unable to open camera path %s\n", fileName);
+        return false;
+    }
+    std::ostringstream script;
+    script << file.rdbuf();
+    return Parse(script.str());
+}
+
+void CameraPath::Apply(int frame, Game *g) const
+{
+    const Frame &f = _frames[frame];
+    if (frame == 0) {
+        for (const Billboard &b : _billboards) {
+            g->billboards.Add(b.x, b.y, b.texture);
+        }
+        // a fixed sequence, cells that are walls are skipped
+        uint32_t seed = 1;
+        for (const Scatter &s : _scatters) {
+            for (int i = 0; i < s.count; i++) {
+                seed = seed * 1103515245 + 12345;
+                const int x = (seed >> 8) % g->map->Width();
+                seed = seed * 1103515245 + 12345;
+                const int y = (seed >> 8) % g->map->Height();
+                if (g->map->Cell(x, y) == 0) {
+                    g->billboards.Add(x + 0.5f, y + 0.5f, s.texture);
+                }
+            }
+        }
+    }
+    if (f.place) {
+        g->playerX = f.x;
+        g->playerY = f.y;
+        g->playerA = f.a;
+    }
+    g->godMode = f.godMode;
+    g->pose = f.pose;
+    g->Move(f.move, f.rotate, _seconds);
+}
+
+CameraPath::CameraPath() : _seconds(1.0f / 60.0f)
+{
+    Parse(DefaultScript);
+}
+
+CameraPath::~CameraPath() {}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "game.h"
+
+// Scripted camera path replayed frame by frame on a Game.
+//
+// A script has one command per line, '#' starts a comment:
+//   at X Y A          place the player at (X, Y) in map cells facing A rad
+//   move M R FRAMES   call Game::Move(M, R) for FRAMES frames
+//   god 0|1           toggle see-through rendering
+//   pose stand|squat  change the player pose
+//   billboard X Y T   put a billboard with texture T at (X, Y) in map cells
+//   scatter N T       pick N cells at random, the same ones on every replay,
+//                     and put a billboard with texture T in the empty ones
+// Every frame advances the game by the same amount of time, so a path always
+// produces the same sequence of views.
+class CameraPath
+{
+public:
+    static const char *DefaultScript;
+
+    bool Parse(const std::string &script);
+    bool Load(const char *fileName);
+    int Frames() const { return static_cast<int>(_frames.size()); }
+    // Advance the game to the given frame, frames must be applied in order
+    // starting from 0 on a freshly constructed Game
+    void Apply(int frame, Game *g) const;
+
+    CameraPath();
+    ~CameraPath();
+
+private:
+    struct Frame {
+        bool place;
+        float x, y, a;
+        int move;
+        int rotate;
+        int godMode;
+        PlayerPose pose;
+    };
+
+    struct Scatter {
+        int count;
+        uint8_t texture;
+    };
+
+    std::vector<Frame> _frames;
+    // added to the game by the first frame
+    std::vector<Billboard> _billboards;
+    std::vector<Scatter> _scatters;
+    float _seconds;
+};
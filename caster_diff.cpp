@@ -0,0 +1,71 @@
+#include "caster_diff.h"
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+void CasterDiff::Sample(const ColumnHit &hits, float x, float y, float a)
+{
+    uint32_t playerX;
+    uint32_t playerY;
+    int16_t playerA;
+    RayCaster::ToView(x, y, a, &playerX, &playerY, &playerA);
+    _reference->Start(playerX, playerY, playerA);
+
+    for (int sx = _phase; sx < _reference->Width(); sx += _period) {
+        WallHit reference;
+        // a ray that does not move finds no wall to compare with
+        if (_reference->TraceWalls(sx, &reference, 1) == 0) {
+            continue;
+        }
+        _stats.columns++;
+        if (hits.textureNo[sx] != reference.textureNo) {
+            _stats.textureMismatches++;
+            continue;
+        }
+        const int height = abs(hits.screenY[sx] - reference.screenY);
+        _stats.heightError += height;
+        _stats.maxHeightError = std::max(_stats.maxHeightError, height);
+        if (reference.depth > 0) {
+            const double depth =
+                fabs(static_cast<double>(hits.depth[sx]) - reference.depth) /
+                reference.depth;
+            _stats.depthError += depth;
+            _stats.maxDepthError = std::max(_stats.maxDepthError, depth);
+        }
+        // the offset along the wall wraps around at the cell edges
+        const int offset = abs(hits.textureX[sx] - reference.textureX);
+        const int textureX = std::min(offset, 256 - offset);
+        _stats.textureXError += textureX;
+        _stats.maxTextureXError = std::max(_stats.maxTextureXError, textureX);
+    }
+    _phase = (_phase + 1) % _period;
+}
+
+void CasterDiff::Print(FILE *file) const
+{
+    const int agree = _stats.columns - _stats.textureMismatches;
+    const double n = agree > 0 ? agree : 1;
+    fprintf(file,
+            "diff: %d columns, wall face mismatch %.2f%%, height error avg "
+            "%.3f max %d(px), depth error avg %.3f%% max %.3f%%, texture x "
+            "error avg %.2f max %d(1/256)\n",
+            _stats.columns,
+            _stats.columns > 0
+                ? 100.0 * _stats.textureMismatches / _stats.columns
+                : 0.0,
+            _stats.heightError / n, _stats.maxHeightError,
+            100 * _stats.depthError / n, 100 * _stats.maxDepthError,
+            _stats.textureXError / n, _stats.maxTextureXError);
+}
+
+void CasterDiff::Reset()
+{
+    _stats = Stats();
+    _phase = 0;
+}
+
+CasterDiff::CasterDiff(RayCaster *reference, int period)
+    : _reference(reference), _period(std::max(period, 1))
+{
+    Reset();
+}
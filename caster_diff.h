@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include "raycaster.h"
+
+// columns apart the differential check samples in a frame
+#define DIFF_PERIOD 16
+
+// Differential check of the walls a renderer drew against a reference
+// caster, such as the fixed-point caster against the float one. The hits
+// the renderer kept of a frame are what its caster traced, through the
+// SIMD walks and the cache of ray angles of the fixed-point caster; only
+// the reference traces again, and only one column in `period`, the next
+// frame the columns next to them, so that the whole screen is covered every
+// `period` frames at a fraction of the cost of tracing it twice.
+class CasterDiff
+{
+public:
+    // Differences accumulated over the columns compared so far
+    struct Stats {
+        int columns;
+        // columns where the casters hit different wall faces; the other
+        // differences are over the columns where they agree
+        int textureMismatches;
+        double heightError;  // sum of |screenY difference|, pixels
+        int maxHeightError;
+        double depthError;  // sum of |depth difference| / reference depth
+        double maxDepthError;
+        double textureXError;  // sum of |textureX difference|, 1/256 cell
+        int maxTextureXError;
+    };
+
+    // Compare the sampled columns of the hits of a frame, such as
+    // Renderer::Hits, with the reference seen from (x, y, a), in map cells
+    // and radians like the player of a Game the frame was drawn for
+    void Sample(const ColumnHit &hits, float x, float y, float a);
+    const Stats &GetStats() const { return _stats; }
+    // Print the statistics on one line
+    void Print(FILE *file) const;
+    void Reset();
+
+    // The reference must have the screen width and field of view the hits
+    // are traced with
+    CasterDiff(RayCaster *reference, int period = DIFF_PERIOD);
+
+private:
+    RayCaster *_reference;
+    const int _period;
+    int _phase;  // first column sampled by the next frame
+    Stats _stats;
+};
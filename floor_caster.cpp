@@ -0,0 +1,51 @@
+#include "floor_caster.h"
+#include <math.h>
+
+FloorCaster::FloorCaster(int width, int height, float wallScale, float tanHalf)
+    : _width(width),
+      _tanHalf(tanHalf),
+      _distance(height - height / 2),
+      _playerX(0),
+      _playerY(0),
+      _leftX(0),
+      _leftY(0),
+      _spanX(0),
+      _spanY(0)
+{
+    // the wall standing on the floor seen by a row ends at that row, through
+    // the middle of its pixels
+    for (size_t row = 0; row < _distance.size(); row++) {
+        _distance[row] =
+            static_cast<int32_t>(wallScale / (row + 0.5f) * 65536.0f);
+    }
+}
+
+void FloorCaster::Start(uint32_t playerX, uint32_t playerY, int16_t playerA)
+{
+    const float angle = playerA * static_cast<float>(M_PI) / 512.0f;
+    const float dirX = sinf(angle);
+    const float dirY = cosf(angle);
+    // screen X grows with the ray angle, towards (cos, -sin)
+    const float planeX = dirY * _tanHalf;
+    const float planeY = -dirX * _tanHalf;
+
+    _playerX = static_cast<int32_t>(playerX << 8);
+    _playerY = static_cast<int32_t>(playerY << 8);
+    _leftX = static_cast<int32_t>((dirX - planeX) * 65536.0f);
+    _leftY = static_cast<int32_t>((dirY - planeY) * 65536.0f);
+    _spanX = static_cast<int32_t>(2.0f * planeX * 65536.0f);
+    _spanY = static_cast<int32_t>(2.0f * planeY * 65536.0f);
+}
+
+FloorCaster::Row FloorCaster::GetRow(int row) const
+{
+    const int64_t distance = _distance[row];
+    Row r;
+    r.x = _playerX + static_cast<int32_t>((distance * _leftX) >> 16);
+    r.y = _playerY + static_cast<int32_t>((distance * _leftY) >> 16);
+    r.stepX = static_cast<int32_t>((distance * _spanX / _width) >> 16);
+    r.stepY = static_cast<int32_t>((distance * _spanY / _width) >> 16);
+    r.stepRow = row + 1 < Rows() ? _distance[row] - _distance[row + 1]
+                                 : 0;
+    return r;
+}
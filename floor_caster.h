@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Floor and ceiling of a frame, cast a screen row at a time. Every row below
+// the horizon sees the floor at a single distance, kept in a table built
+// once, and the floor position under the pixels of a row moves by the same
+// step from one to the next: filling a row costs two additions per pixel.
+// The ceiling row mirrored above the horizon sees the same positions.
+//
+// Positions are 16.16 fixed-point cells. The view is given the way the
+// fixed-point caster takes it: the player in 1/256 cells, the angle as 1024
+// per full circle.
+class FloorCaster
+{
+public:
+    // Floor under the pixels of a row: the position under its first pixel
+    // and the step between pixels, 16.16 cells, and how much farther the
+    // floor of the next row is, the same for both
+    struct Row {
+        int32_t x;
+        int32_t y;
+        int32_t stepX;
+        int32_t stepY;
+        int32_t stepRow;
+    };
+
+    // The walls of the caster are 2 * wallScale / distance pixels tall, and
+    // column x looks along (x - width / 2) / (width / 2) * tanHalf
+    FloorCaster(int width, int height, float wallScale, float tanHalf);
+
+    void Start(uint32_t playerX, uint32_t playerY, int16_t playerA);
+    // floor `row` rows below the horizon, [0, height - height / 2)
+    Row GetRow(int row) const;
+    int Rows() const { return static_cast<int>(_distance.size()); }
+
+private:
+    int _width;
+    float _tanHalf;
+    // distance of the floor seen by every row, 16.16 cells
+    std::vector<int32_t> _distance;
+    // player and the view directions through the left and right screen
+    // edges, 16.16
+    int32_t _playerX;
+    int32_t _playerY;
+    int32_t _leftX;
+    int32_t _leftY;
+    int32_t _spanX;
+    int32_t _spanY;
+};
@@ -0,0 +1,67 @@
+#include "frame_pipeline.h"
+
+void FramePipeline::Work()
+{
+    for (;;) {
+        int slot;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _queued.wait(lock, [&] {
+                return _exiting || _renderedCount < _submitted;
+            });
+            if (_exiting) {
+                return;
+            }
+            slot = _renderedCount % _slots;
+        }
+
+        _render(slot);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _renderedCount++;
+        _rendered.notify_one();
+    }
+}
+
+void FramePipeline::Submit()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _submitted++;
+    }
+    _queued.notify_one();
+}
+
+int FramePipeline::WaitOldest()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _rendered.wait(lock, [&] { return _renderedCount > _released; });
+    return _released % _slots;
+}
+
+void FramePipeline::Release()
+{
+    _released++;
+}
+
+FramePipeline::FramePipeline(int slots,
+                             const std::function<void(int)> &render)
+    : _slots(slots < 1 ? 1 : slots),
+      _render(render),
+      _submitted(0),
+      _released(0),
+      _renderedCount(0),
+      _exiting(false)
+{
+    _thread = std::thread(&FramePipeline::Work, this);
+}
+
+FramePipeline::~FramePipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _exiting = true;
+    }
+    _queued.notify_one();
+    _thread.join();
+}
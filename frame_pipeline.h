@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Frames rendered on a thread of their own, in a ring of slots, while the
+// calling thread prepares the next ones and shows the finished ones. A slot
+// is in flight from Submit to Release: rendered by the pipeline, then shown
+// by the caller. At most Slots() frames are in flight, which bounds how far
+// the frame on screen lags behind the frame being prepared; one slot renders
+// and shows every frame in turn.
+//
+//   prepare frame in NextSlot(), Submit()
+//   once InFlight() == Slots(): show WaitOldest(), Release()
+class FramePipeline
+{
+public:
+    int Slots() const { return _slots; }
+    int InFlight() const { return _submitted - _released; }
+    // Slot to prepare the next frame in, free while InFlight() < Slots()
+    int NextSlot() const { return _submitted % _slots; }
+    // Render the frame prepared in NextSlot() in the background
+    void Submit();
+    // Wait until the oldest frame in flight is rendered and return its slot
+    int WaitOldest();
+    // The oldest frame is shown, its slot takes a new frame
+    void Release();
+
+    // render(slot) renders the frame prepared in slot
+    FramePipeline(int slots, const std::function<void(int)> &render);
+    ~FramePipeline();
+
+private:
+    const int _slots;
+    const std::function<void(int)> _render;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _queued;
+    std::condition_variable _rendered;
+    // Frames counted from the start. Only the caller changes _submitted and
+    // _released, and _submitted under _mutex since the thread reads it;
+    // _renderedCount is guarded by _mutex.
+    int _submitted;
+    int _released;
+    int _renderedCount;
+    bool _exiting;
+
+    void Work();
+};
@@ -3,7 +3,6 @@
 
 #include "game.h"
 #include "raycaster.h"
-#include "raycaster_data.h"
 
 void Game::Move(int m, int r, float seconds)
 {
@@ -14,10 +13,7 @@ void Game::Move(int m, int r, float seconds)
     float try_move_y = 0.5f * m * cos(playerA) * seconds * 5.0f;
     int x = playerX + try_move_x;
     int y = playerY + try_move_y;
-    if (((g_map32[(x / OBSTACLES_PER_ELEMENT) + (y * ELEMENTS_PER_ROW)] >>
-          ((OBSTACLES_PER_ELEMENT - x % OBSTACLES_PER_ELEMENT) *
-           OBSTACLE_SIZE)) &
-         OBSTACLE_MASK) == 0) {
+    if (map->Cell(x, y) == 0) {
         playerX += try_move_x;
         playerY += try_move_y;
     } else {
@@ -34,24 +30,24 @@ void Game::Move(int m, int r, float seconds)
 
     if (playerX < 1) {
         playerX = 1.01f;
-    } else if (playerX > MAP_X - 2) {
-        playerX = MAP_X - 2 - 0.01f;
+    } else if (playerX > map->Width() - 2) {
+        playerX = map->Width() - 2 - 0.01f;
     }
     if (playerY < 1) {
         playerY = 1.01f;
-    } else if (playerY > MAP_Y - 2) {
-        playerY = MAP_Y - 2 - 0.01f;
+    } else if (playerY > map->Height() - 2) {
+        playerY = map->Height() - 2 - 0.01f;
     }
 }
 
-Game::Game()
+Game::Game(const Map &map) : map(&map), billboards(map)
 {
     pose = POSE_STAND;
     moving = 0;
     godMode = 0;
-    playerX = 23.03f;
-    playerY = 6.8f;
-    playerA = 5.25f;
+    playerX = map.StartX();
+    playerY = map.StartY();
+    playerA = map.StartA();
 }
 
 Game::~Game() {}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdint.h>
+#include "billboards.h"
+#include "map.h"
 
 #define ARM_POINT_LEN 10
 #define ARM_POINT_RAD 10
@@ -17,7 +19,10 @@ public:
     void Move(int m, int r, float seconds);
 
     float playerX, playerY, playerA;
+    // the world walked through, read in place
+    const Map *map;
+    Billboards billboards;
 
-    Game();
+    explicit Game(const Map &map = Map::Default());
     ~Game();
 };
@@ -0,0 +1,232 @@
+// offscreen renderer without any display dependency
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "camera_path.h"
+#include "caster_diff.h"
+#include "game.h"
+#include "map.h"
+#include "raycaster.h"
+#include "raycaster_fixed.h"
+#include "raycaster_float.h"
+#include "renderer.h"
+
+using namespace std;
+
+static bool WritePPM(const char *fileName,
+                     const uint32_t *fb,
+                     int width,
+                     int height)
+{
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Unable to write %s\n", fileName);
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    vector<uint8_t> row(width * 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint32_t c = fb[y * width + x];
+            row[x * 3 + 0] = (c >> 16) & 0xFF;
+            row[x * 3 + 1] = (c >> 8) & 0xFF;
+            row[x * 3 + 2] = c & 0xFF;
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    fclose(file);
+    return true;
+}
+
+static void Usage(const char *name)
+{
+    printf(
+        "Usage: %s [options]\n"
+        "  -c, --caster fixed|float  ray caster to render with (fixed)\n"
+        "  -p, --path FILE           camera path script (built-in path)\n"
+        "  -M, --map FILE            world map (built-in map)\n"
+        "  -n, --frames N            stop after N frames (whole path)\n"
+        "  -t, --threads N           rendering threads (1)\n"
+        "  -W, --width N             screen width (%d)\n"
+        "  -H, --height N            screen height (%d)\n"
+        "  -f, --fov DEGREES         horizontal field of view (caster "
+        "default)\n"
+        "  -m, --column-major        render columns contiguously, then "
+        "transpose\n"
+        "      --no-mipmaps          sample walls at full texture size\n"
+        "  -F, --floor               texture the floor and ceiling\n"
+        "  -o, --output PREFIX       write frames as PREFIX0000.ppm, ...\n"
+        "  -e, --every N             with -o, write every N-th frame (1)\n"
+        "  -D, --diff N              compare the walls drawn with the float "
+        "caster\n"
+        "                            on every N-th column, rotating (off)\n",
+        name, SCREEN_WIDTH, SCREEN_HEIGHT);
+}
+
+int main(int argc, char *args[])
+{
+    const char *casterName = "fixed";
+    const char *pathFile = NULL;
+    const char *mapFile = NULL;
+    const char *output = NULL;
+    int frames = -1;
+    int threads = 1;
+    bool columnMajor = false;
+    bool mipmaps = true;
+    bool texturedFloor = false;
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+    double fov = 0;
+    int every = 1;
+    int diffPeriod = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = args[i];
+        const char *value = i + 1 < argc ? args[i + 1] : NULL;
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            Usage(args[0]);
+            return 0;
+        } else if (!strcmp(arg, "-m") || !strcmp(arg, "--column-major")) {
+            columnMajor = true;
+            continue;
+        } else if (!strcmp(arg, "--no-mipmaps")) {
+            mipmaps = false;
+            continue;
+        } else if (!strcmp(arg, "-F") || !strcmp(arg, "--floor")) {
+            texturedFloor = true;
+            continue;
+        } else if (value == NULL) {
+            Usage(args[0]);
+            return 1;
+        } else if (!strcmp(arg, "-c") || !strcmp(arg, "--caster")) {
+            casterName = value;
+        } else if (!strcmp(arg, "-p") || !strcmp(arg, "--path")) {
+            pathFile = value;
+        } else if (!strcmp(arg, "-M") || !strcmp(arg, "--map")) {
+            mapFile = value;
+        } else if (!strcmp(arg, "-n") || !strcmp(arg, "--frames")) {
+            frames = atoi(value);
+        } else if (!strcmp(arg, "-t") || !strcmp(arg, "--threads")) {
+            threads = atoi(value);
+        } else if (!strcmp(arg, "-W") || !strcmp(arg, "--width")) {
+            width = atoi(value);
+        } else if (!strcmp(arg, "-H") || !strcmp(arg, "--height")) {
+            height = atoi(value);
+        } else if (!strcmp(arg, "-f") || !strcmp(arg, "--fov")) {
+            fov = atof(value) * M_PI / 180;
+        } else if (!strcmp(arg, "-o") || !strcmp(arg, "--output")) {
+            output = value;
+        } else if (!strcmp(arg, "-e") || !strcmp(arg, "--every")) {
+            every = atoi(value) > 0 ? atoi(value) : 1;
+        } else if (!strcmp(arg, "-D") || !strcmp(arg, "--diff")) {
+            diffPeriod = atoi(value) > 0 ? atoi(value) : 1;
+        } else {
+            Usage(args[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (width < MIN_SCREEN_SIZE || width > MAX_SCREEN_SIZE ||
+        height < MIN_SCREEN_SIZE || height > MAX_SCREEN_SIZE) {
+        fprintf(stderr, "Resolution must be within %dx%d and %dx%d\n",
+                MIN_SCREEN_SIZE, MIN_SCREEN_SIZE, MAX_SCREEN_SIZE,
+                MAX_SCREEN_SIZE);
+        return 1;
+    }
+    if (fov < 0 || fov >= M_PI) {
+        fprintf(stderr, "Field of view must be below 180 degrees\n");
+        return 1;
+    }
+
+    Map map;
+    if (mapFile != NULL && !map.Load(mapFile)) {
+        return 1;
+    }
+
+    unique_ptr<RayCaster> caster;
+    if (!strcmp(casterName, "fixed")) {
+        fov = fov > 0 ? fov : FIXED_FOV_X;
+        caster.reset(new RayCasterFixed(width, height, fov, map));
+    } else if (!strcmp(casterName, "float")) {
+        fov = fov > 0 ? fov : FOV_X;
+        caster.reset(new RayCasterFloat(width, height, fov, map));
+    } else {
+        fprintf(stderr, "Unknown caster %s\n", casterName);
+        return 1;
+    }
+
+    CameraPath path;
+    if (pathFile != NULL && !path.Load(pathFile)) {
+        return 1;
+    }
+    if (frames < 0 || frames > path.Frames()) {
+        frames = path.Frames();
+    }
+
+    Game game(map);
+    Renderer renderer(caster.get(), threads);
+    renderer.SetColumnMajor(columnMajor);
+    renderer.SetMipmaps(mipmaps);
+    renderer.SetTexturedFloor(texturedFloor);
+    vector<uint32_t> frameBuffer(width * height);
+    // the walls drawn are checked against the float caster, with the field
+    // of view of the caster that drew them
+    unique_ptr<RayCaster> reference;
+    unique_ptr<CasterDiff> diff;
+    if (diffPeriod > 0) {
+        reference.reset(new RayCasterFloat(width, height, fov, map));
+        diff.reset(new CasterDiff(reference.get(), diffPeriod));
+    }
+    double totalSec = 0;
+    double minSec = 0;
+    double maxSec = 0;
+
+    for (int f = 0; f < frames; f++) {
+        path.Apply(f, &game);
+
+        const auto start = chrono::steady_clock::now();
+        renderer.TraceFrame(&game, frameBuffer.data());
+        renderer.RenderGame(&game, frameBuffer.data());
+        const double sec =
+            chrono::duration<double>(chrono::steady_clock::now() - start)
+                .count();
+
+        totalSec += sec;
+        minSec = f == 0 || sec < minSec ? sec : minSec;
+        maxSec = sec > maxSec ? sec : maxSec;
+        if (diff) {
+            diff->Sample(renderer.Hits(), game.playerX, game.playerY,
+                         game.playerA);
+        }
+
+        if (output != NULL && f % every == 0) {
+            char fileName[1024];
+            snprintf(fileName, sizeof(fileName), "%s%04d.ppm", output, f);
+            if (!WritePPM(fileName, frameBuffer.data(), width, height)) {
+                return 1;
+            }
+        }
+    }
+
+    printf("caster: %s, threads: %d, resolution: %dx%d%s%s%s\n", casterName,
+           renderer.GetThreadCount(), width, height,
+           columnMajor ? ", column-major" : "", mipmaps ? "" : ", no mipmaps",
+           texturedFloor ? ", textured floor" : "");
+    if (frames > 0) {
+        printf(
+            "frames: %d, total: %.6f(s), FPS: %.2f, frame: avg %.6f(s), "
+            "min %.6f(s), max %.6f(s)\n",
+            frames, totalSec, frames / totalSec, totalSec / frames, minSec,
+            maxSec);
+    }
+    if (diff) {
+        diff->Print(stdout);
+    }
+    return 0;
+}
@@ -1,9 +1,16 @@
 #include <SDL.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <vector>
 
+#include "caster_diff.h"
+#include "frame_pipeline.h"
 #include "game.h"
+#include "map.h"
 #include "raycaster.h"
 #include "raycaster_fixed.h"
 #include "raycaster_float.h"
@@ -11,23 +18,76 @@
 
 using namespace std;
 
-static void DrawBuffer(SDL_Renderer *sdlRenderer,
-                       SDL_Texture *sdlTexture,
-                       uint32_t *fb,
-                       int dx)
+// What the viewer renders: one of the casters, both side by side, or the
+// fixed-point one checked against the float one on a few columns a frame
+enum ViewerMode { MODE_FIXED, MODE_FLOAT, MODE_BOTH, MODE_DIFF };
+
+// A frame of the viewer: the game as it was when the frame was prepared,
+// which the game moving on does not change, and the textures that show it.
+// The textures stay locked while the frame is in flight, the renderers draw
+// straight into their pixels, which they only write as SDL requires.
+struct Frame {
+    Game game;
+    SDL_Texture *floatTexture;
+    SDL_Texture *fixedTexture;
+    uint32_t *floatPixels;
+    uint32_t *fixedPixels;
+    int floatStride;
+    int fixedStride;
+    float floatRenderSeconds;
+    float fixedRenderSeconds;
+
+    explicit Frame(const Map &map)
+        : game(map),
+          floatTexture(NULL),
+          fixedTexture(NULL),
+          floatPixels(NULL),
+          fixedPixels(NULL),
+          floatStride(0),
+          fixedStride(0),
+          floatRenderSeconds(0),
+          fixedRenderSeconds(0)
+    {
+    }
+};
+
+// what the renderers read of a game
+static void CopyView(const Game &from, Game *to)
+{
+    to->pose = from.pose;
+    to->moving = from.moving;
+    to->godMode = from.godMode;
+    to->playerX = from.playerX;
+    to->playerY = from.playerY;
+    to->playerA = from.playerA;
+}
+
+// Lock a texture to draw into and return its pixels, rows stride apart
+static uint32_t *LockTexture(SDL_Texture *sdlTexture, int *stride)
 {
     int pitch = 0;
     void *pixelsPtr;
     if (SDL_LockTexture(sdlTexture, NULL, &pixelsPtr, &pitch)) {
         throw runtime_error("Unable to lock texture");
     }
-    memcpy(pixelsPtr, fb, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t));
+    *stride = pitch / sizeof(uint32_t);
+    return static_cast<uint32_t *>(pixelsPtr);
+}
+
+// Unlock a texture drawn into and copy it to the screen
+static void DrawTexture(SDL_Renderer *sdlRenderer,
+                        SDL_Texture *sdlTexture,
+                        int width,
+                        int height,
+                        int scale,
+                        int dx)
+{
     SDL_UnlockTexture(sdlTexture);
     SDL_Rect r;
-    r.x = dx * SCREEN_SCALE;
+    r.x = dx * scale;
     r.y = 0;
-    r.w = SCREEN_WIDTH * SCREEN_SCALE;
-    r.h = SCREEN_HEIGHT * SCREEN_SCALE;
+    r.w = width * scale;
+    r.h = height * scale;
     SDL_RenderCopy(sdlRenderer, sdlTexture, NULL, &r);
 }
 
@@ -87,34 +147,146 @@ void printPerformanceInfo(float floatRenderSec,
     overRC = smoothFactor * overRC + (1 - smoothFactor) * overallSec;
     if ((currentTick - lastPrintTick) / static_cast<float>(tickFrequency) >
         0.2f) {
-        printf("fixed: %.6f(s), float: %.6f(s), FPS: %.6f(s)\n", fixedRC,
-               floatRC, 1 / overRC);
+        // a caster that is not rendered takes no time
+        if (fixedRC > 0) {
+            printf("fixed: %.6f(s), ", fixedRC);
+        }
+        if (floatRC > 0) {
+            printf("float: %.6f(s), ", floatRC);
+        }
+        printf("FPS: %.6f(s)\n", 1 / overRC);
         lastPrintTick = currentTick;
     }
 }
 
 int main(int argc, char *args[])
 {
+    int threads = 1;
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+    double fov = 0;
+    const char *mapFile = NULL;
+    bool texturedFloor = false;
+    // frames in flight: one being shown while the next one renders
+    int pipelineSlots = 2;
+    ViewerMode mode = MODE_BOTH;
+    int diffPeriod = DIFF_PERIOD;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(args[i], "-F") || !strcmp(args[i], "--floor")) {
+            texturedFloor = true;
+        } else if (i + 1 == argc) {
+            break;
+        } else if (!strcmp(args[i], "-t") || !strcmp(args[i], "--threads")) {
+            threads = atoi(args[++i]);
+        } else if (!strcmp(args[i], "-W") || !strcmp(args[i], "--width")) {
+            width = atoi(args[++i]);
+        } else if (!strcmp(args[i], "-H") || !strcmp(args[i], "--height")) {
+            height = atoi(args[++i]);
+        } else if (!strcmp(args[i], "-f") || !strcmp(args[i], "--fov")) {
+            fov = atof(args[++i]) * M_PI / 180;
+        } else if (!strcmp(args[i], "-M") || !strcmp(args[i], "--map")) {
+            mapFile = args[++i];
+        } else if (!strcmp(args[i], "-P") ||
+                   !strcmp(args[i], "--pipeline")) {
+            pipelineSlots = atoi(args[++i]);
+        } else if (!strcmp(args[i], "-D") || !strcmp(args[i], "--diff")) {
+            mode = MODE_DIFF;
+            diffPeriod = atoi(args[++i]);
+        } else if (!strcmp(args[i], "--mode")) {
+            const char *name = args[++i];
+            if (!strcmp(name, "fixed")) {
+                mode = MODE_FIXED;
+            } else if (!strcmp(name, "float")) {
+                mode = MODE_FLOAT;
+            } else if (!strcmp(name, "both")) {
+                mode = MODE_BOTH;
+            } else if (!strcmp(name, "diff")) {
+                mode = MODE_DIFF;
+            } else {
+                printf("Unknown mode %s, expected fixed, float, both or "
+                       "diff\n",
+                       name);
+                return 1;
+            }
+        }
+    }
+    if (width < MIN_SCREEN_SIZE || width > MAX_SCREEN_SIZE ||
+        height < MIN_SCREEN_SIZE || height > MAX_SCREEN_SIZE ||
+        fov < 0 || fov >= M_PI) {
+        printf("Unsupported resolution %dx%d or field of view\n", width,
+               height);
+        return 1;
+    }
+    if (pipelineSlots < 1 || pipelineSlots > 4) {
+        printf("Frames in flight must be within 1 and 4\n");
+        return 1;
+    }
+    if (diffPeriod < 1) {
+        printf("Columns apart the diff samples must be at least 1\n");
+        return 1;
+    }
+    const bool showFixed = mode != MODE_FLOAT;
+    const bool showFloat = mode == MODE_FLOAT || mode == MODE_BOTH;
+    const int panes = showFixed && showFloat ? 2 : 1;
+    Map map;
+    if (mapFile != NULL && !map.Load(mapFile)) {
+        return 1;
+    }
+    // only the default resolution is small enough to be magnified
+    const int scale = width <= SCREEN_WIDTH ? SCREEN_SCALE : 1;
+
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
     } else {
-        SDL_Window *sdlWindow =
-            SDL_CreateWindow("RayCaster [fixed-point vs. floating-point]",
-                             SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-                             SCREEN_SCALE * (SCREEN_WIDTH * 2 + 1),
-                             SCREEN_SCALE * SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+        const char *title = "RayCaster [fixed-point vs. floating-point]";
+        if (mode == MODE_FIXED) {
+            title = "RayCaster [fixed-point]";
+        } else if (mode == MODE_FLOAT) {
+            title = "RayCaster [floating-point]";
+        } else if (mode == MODE_DIFF) {
+            title = "RayCaster [fixed-point, checked against floating-point]";
+        }
+        SDL_Window *sdlWindow = SDL_CreateWindow(
+            title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+            scale * (width * panes + panes - 1), scale * height,
+            SDL_WINDOW_SHOWN);
 
         if (sdlWindow == NULL) {
             printf("Window could not be created! SDL_Error: %s\n",
                    SDL_GetError());
         } else {
-            Game game;
-            RayCasterFloat floatCaster;
-            Renderer floatRenderer(&floatCaster);
-            uint32_t floatBuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
-            RayCasterFixed fixedCaster;
-            Renderer fixedRenderer(&fixedCaster);
-            uint32_t fixedBuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+            Game game(map);
+            // only the casters on screen are built and rendered
+            unique_ptr<RayCaster> floatCaster;
+            unique_ptr<Renderer> floatRenderer;
+            if (showFloat) {
+                floatCaster.reset(new RayCasterFloat(
+                    width, height, fov > 0 ? fov : FOV_X, map));
+                floatRenderer.reset(new Renderer(floatCaster.get(), threads));
+                floatRenderer->SetTexturedFloor(texturedFloor);
+            }
+            unique_ptr<RayCaster> fixedCaster;
+            unique_ptr<Renderer> fixedRenderer;
+            if (showFixed) {
+                fixedCaster.reset(new RayCasterFixed(
+                    width, height, fov > 0 ? fov : FIXED_FOV_X, map));
+                fixedRenderer.reset(new Renderer(fixedCaster.get(), threads));
+                fixedRenderer->SetTexturedFloor(texturedFloor);
+            }
+            // The diff checks the walls the fixed-point renderer drew against
+            // a reference caster that only traces the sampled columns, with
+            // the field of view of the fixed-point tables. The
+            // statistics are printed and started over every DIFF_PRINT_FRAMES
+            // frames.
+            const int DIFF_PRINT_FRAMES = 128;
+            unique_ptr<RayCaster> referenceCaster;
+            unique_ptr<CasterDiff> diff;
+            int diffFrames = 0;
+            if (mode == MODE_DIFF) {
+                referenceCaster.reset(new RayCasterFloat(
+                    width, height, fov > 0 ? fov : FIXED_FOV_X, map));
+                diff.reset(new CasterDiff(referenceCaster.get(), diffPeriod));
+            }
             int moveDirection = 0;
             int rotateDirection = 0;
             bool isExiting = false;
@@ -124,37 +296,106 @@ int main(int argc, char *args[])
 
             SDL_Renderer *sdlRenderer =
                 SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_ACCELERATED);
-            SDL_Texture *fixedTexture = SDL_CreateTexture(
-                sdlRenderer, SDL_PIXELFORMAT_ARGB8888,
-                SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
-            SDL_Texture *floatTexture = SDL_CreateTexture(
-                sdlRenderer, SDL_PIXELFORMAT_ARGB8888,
-                SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
 
-            while (!isExiting) {
+            // Frames are rendered on a thread of their own while this one
+            // moves the game and shows the frame rendered before, so a frame
+            // takes as long as the slowest of them rather than all of them.
+            // SDL is only called from this thread.
+            vector<Frame> frames;
+            for (int i = 0; i < pipelineSlots; i++) {
+                frames.emplace_back(map);
+                if (showFixed) {
+                    frames.back().fixedTexture = SDL_CreateTexture(
+                        sdlRenderer, SDL_PIXELFORMAT_ARGB8888,
+                        SDL_TEXTUREACCESS_STREAMING, width, height);
+                }
+                if (showFloat) {
+                    frames.back().floatTexture = SDL_CreateTexture(
+                        sdlRenderer, SDL_PIXELFORMAT_ARGB8888,
+                        SDL_TEXTUREACCESS_STREAMING, width, height);
+                }
+            }
+            auto render = [&](int slot) {
+                Frame &f = frames[slot];
+
                 /* Float point render start */
-                const auto renderFloatTickStart = SDL_GetPerformanceCounter();
-                floatRenderer.TraceFrame(&game, floatBuffer);
-                floatRenderer.RenderGame(&game, floatBuffer);
-                const auto renderFloatTickEnd = SDL_GetPerformanceCounter();
-                const auto floatRenderSeconds =
-                    (renderFloatTickEnd - renderFloatTickStart) /
-                    static_cast<float>(tickFrequency);
+                if (showFloat) {
+                    const auto renderFloatTickStart =
+                        SDL_GetPerformanceCounter();
+                    floatRenderer->TraceFrame(&f.game, f.floatPixels,
+                                              f.floatStride);
+                    floatRenderer->RenderGame(&f.game, f.floatPixels,
+                                              f.floatStride);
+                    const auto renderFloatTickEnd =
+                        SDL_GetPerformanceCounter();
+                    f.floatRenderSeconds =
+                        (renderFloatTickEnd - renderFloatTickStart) /
+                        static_cast<float>(tickFrequency);
+                }
 
                 /* Fixed point render start */
-                const auto renderFixedTickStart = SDL_GetPerformanceCounter();
-                fixedRenderer.TraceFrame(&game, fixedBuffer);
-                fixedRenderer.RenderGame(&game, fixedBuffer);
-                const auto renderFixedTickEnd = SDL_GetPerformanceCounter();
-                const auto fixedRenderSeconds =
-                    (renderFixedTickEnd - renderFixedTickStart) /
-                    static_cast<float>(tickFrequency);
+                if (showFixed) {
+                    const auto renderFixedTickStart =
+                        SDL_GetPerformanceCounter();
+                    fixedRenderer->TraceFrame(&f.game, f.fixedPixels,
+                                              f.fixedStride);
+                    fixedRenderer->RenderGame(&f.game, f.fixedPixels,
+                                              f.fixedStride);
+                    const auto renderFixedTickEnd =
+                        SDL_GetPerformanceCounter();
+                    f.fixedRenderSeconds =
+                        (renderFixedTickEnd - renderFixedTickStart) /
+                        static_cast<float>(tickFrequency);
+                }
 
-                DrawBuffer(sdlRenderer, fixedTexture, fixedBuffer, 0);
-                DrawBuffer(sdlRenderer, floatTexture, floatBuffer,
-                           SCREEN_WIDTH + 1);
+                /* Differential check, outside the timing */
+                if (diff) {
+                    diff->Sample(fixedRenderer->Hits(), f.game.playerX,
+                                 f.game.playerY, f.game.playerA);
+                    if (++diffFrames == DIFF_PRINT_FRAMES) {
+                        diff->Print(stdout);
+                        diff->Reset();
+                        diffFrames = 0;
+                    }
+                }
+            };
+            unique_ptr<FramePipeline> pipeline(
+                new FramePipeline(pipelineSlots, render));
 
-                SDL_RenderPresent(sdlRenderer);
+            while (!isExiting) {
+                Frame &next = frames[pipeline->NextSlot()];
+                CopyView(game, &next.game);
+                if (showFixed) {
+                    next.fixedPixels =
+                        LockTexture(next.fixedTexture, &next.fixedStride);
+                }
+                if (showFloat) {
+                    next.floatPixels =
+                        LockTexture(next.floatTexture, &next.floatStride);
+                }
+                pipeline->Submit();
+
+                // show the oldest frame once every slot is in flight
+                const bool show = pipeline->InFlight() == pipeline->Slots();
+                float floatRenderSeconds = 0;
+                float fixedRenderSeconds = 0;
+                if (show) {
+                    const Frame &shown = frames[pipeline->WaitOldest()];
+                    if (showFixed) {
+                        DrawTexture(sdlRenderer, shown.fixedTexture, width,
+                                    height, scale, 0);
+                    }
+                    if (showFloat) {
+                        DrawTexture(sdlRenderer, shown.floatTexture, width,
+                                    height, scale,
+                                    showFixed ? width + 1 : 0);
+                    }
+                    floatRenderSeconds = shown.floatRenderSeconds;
+                    fixedRenderSeconds = shown.fixedRenderSeconds;
+                    pipeline->Release();
+
+                    SDL_RenderPresent(sdlRenderer);
+                }
 
                 if (SDL_PollEvent(&event)) {
                     isExiting = ProcessEvent(event, &moveDirection,
@@ -167,11 +408,21 @@ int main(int argc, char *args[])
                                      static_cast<float>(tickFrequency);
                 tickCounter = nextCounter;
                 game.Move(moveDirection, rotateDirection, seconds);
-                printPerformanceInfo(floatRenderSeconds, fixedRenderSeconds,
-                                     seconds);
+                if (show) {
+                    printPerformanceInfo(floatRenderSeconds,
+                                         fixedRenderSeconds, seconds);
+                }
+            }
+            // no frame may be drawn into a texture that is gone
+            pipeline.reset();
+            for (Frame &f : frames) {
+                if (f.floatTexture != NULL) {
+                    SDL_DestroyTexture(f.floatTexture);
+                }
+                if (f.fixedTexture != NULL) {
+                    SDL_DestroyTexture(f.fixedTexture);
+                }
             }
-            SDL_DestroyTexture(floatTexture);
-            SDL_DestroyTexture(fixedTexture);
             SDL_DestroyRenderer(sdlRenderer);
             SDL_DestroyWindow(sdlWindow);
         }
@@ -0,0 +1,295 @@
+#include "map.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <utility>
+#include "raycaster.h"
+#include "raycaster_data.h"
+
+#define MAP_VERSION 2
+// Blocks of a version 2 file checked against its cells when it is loaded
+#define MAP_BLOCK_SAMPLES 256
+
+struct MapHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    float startX;
+    float startY;
+    float startA;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(MapHeader) == 32, "map header must be 32 bytes");
+
+// grids are stored in whole 32-bit words
+static size_t Padded(size_t size)
+{
+    return (size + 3) & ~static_cast<size_t>(3);
+}
+
+static bool WritePadded(FILE *file, const uint8_t *data, size_t size)
+{
+    static const uint8_t zeros[3] = {0, 0, 0};
+    const size_t padding = Padded(size) - size;
+    return fwrite(data, 1, size, file) == size &&
+           fwrite(zeros, 1, padding, file) == padding;
+}
+
+// Whether block (bx, by) of a width by height grid holds a wall or reaches
+// past the grid, as BuildBlocks marks it
+static bool BlockOccupied(const uint8_t *cells,
+                          int width,
+                          int height,
+                          int bx,
+                          int by)
+{
+    const int x0 = bx << MAP_BLOCK_BITS;
+    const int y0 = by << MAP_BLOCK_BITS;
+    if (x0 + MAP_BLOCK_SIZE > width || y0 + MAP_BLOCK_SIZE > height) {
+        return true;
+    }
+    for (int y = y0; y < y0 + MAP_BLOCK_SIZE; y++) {
+        const uint8_t *row = cells + static_cast<size_t>(y) * width;
+        for (int x = x0; x < x0 + MAP_BLOCK_SIZE; x++) {
+            if (row[x] != 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Compare MAP_BLOCK_SAMPLES blocks spread over the grid, or all of them on
+// smaller grids, with the cells they cover. Loading stays independent of
+// the size of the map: this catches blocks written for other cells, not a
+// single wrong block of a large map.
+static bool SampleBlocks(const uint8_t *cells,
+                         const uint8_t *blocks,
+                         int width,
+                         int height)
+{
+    const int blocksX = (width + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS;
+    const int blocksY = (height + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS;
+    const int64_t total = static_cast<int64_t>(blocksX) * blocksY;
+    const int64_t samples = std::min<int64_t>(total, MAP_BLOCK_SAMPLES);
+    for (int64_t i = 0; i < samples; i++) {
+        // the first and the last block, which reaches past odd sizes
+        const int64_t block =
+            samples > 1 ? i * (total - 1) / (samples - 1) : 0;
+        const int bx = static_cast<int>(block % blocksX);
+        const int by = static_cast<int>(block / blocksX);
+        if ((blocks[block] != 0) !=
+            BlockOccupied(cells, width, height, bx, by)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Map::Map()
+    : _width(MAP_X),
+      _height(MAP_Y),
+      _startX(23.03f),
+      _startY(6.8f),
+      _startA(5.25f),
+      _mapping(NULL),
+      _mappingSize(0)
+{
+    // g_map32 packs 8 cells of 4 bits per word, the first cell of a word in
+    // its lowest bits and the others from the top down. The last row and
+    // column have always been treated as walls.
+    _storage.resize(Padded(MAP_X * MAP_Y));
+    for (int y = 0; y < MAP_Y; y++) {
+        for (int x = 0; x < MAP_X; x++) {
+            const int shift =
+                (OBSTACLES_PER_ELEMENT - x % OBSTACLES_PER_ELEMENT) *
+                OBSTACLE_SIZE % MAP_ELEMENT_SIZE;
+            uint8_t cell =
+                (g_map32[x / OBSTACLES_PER_ELEMENT + y * ELEMENTS_PER_ROW] >>
+                 shift) &
+                OBSTACLE_MASK;
+            if (x == MAP_X - 1 || y == MAP_Y - 1) {
+                cell = MAP_BORDER_CELL;
+            }
+            _storage[y * MAP_X + x] = cell;
+        }
+    }
+    _cells = _storage.data();
+    BuildBlocks();
+}
+
+Map::Map(int width,
+         int height,
+         std::vector<uint8_t> cells,
+         float startX,
+         float startY,
+         float startA)
+    : _width(width),
+      _height(height),
+      _startX(startX),
+      _startY(startY),
+      _startA(startA),
+      _storage(std::move(cells)),
+      _mapping(NULL),
+      _mappingSize(0)
+{
+    _storage.resize(Padded(width * height));
+    _cells = _storage.data();
+    BuildBlocks();
+}
+
+Map::~Map()
+{
+    Unmap();
+}
+
+void Map::Unmap()
+{
+    if (_mapping != NULL) {
+        munmap(_mapping, _mappingSize);
+        _mapping = NULL;
+        _mappingSize = 0;
+    }
+}
+
+void Map::BuildBlocks()
+{
+    _blocksX = (_width + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS;
+    _blocksY = (_height + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS;
+    _blockStorage.assign(Padded(_blocksX * _blocksY), 0);
+    uint8_t *blocks = _blockStorage.data();
+    for (int y = 0; y < _height; y++) {
+        const uint8_t *row = _cells + static_cast<size_t>(y) * _width;
+        uint8_t *blockRow = blocks + (y >> MAP_BLOCK_BITS) * _blocksX;
+        for (int x = 0; x < _width; x++) {
+            blockRow[x >> MAP_BLOCK_BITS] |= row[x] != 0;
+        }
+    }
+    // blocks reaching past the grid hold border walls
+    if (_width % MAP_BLOCK_SIZE != 0) {
+        for (int by = 0; by < _blocksY; by++) {
+            blocks[by * _blocksX + _blocksX - 1] = 1;
+        }
+    }
+    if (_height % MAP_BLOCK_SIZE != 0) {
+        for (int bx = 0; bx < _blocksX; bx++) {
+            blocks[(_blocksY - 1) * _blocksX + bx] = 1;
+        }
+    }
+    _blocks = blocks;
+}
+
+bool Map::Load(const char *fileName)
+{
+    const int fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Unable to open map %s\n", fileName);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(MapHeader)) {
+        fprintf(stderr, "Map %s is too short\n", fileName);
+        close(fd);
+        return false;
+    }
+    const size_t size = st.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Unable to map %s\n", fileName);
+        return false;
+    }
+
+    MapHeader header;
+    memcpy(&header, mapping, sizeof(header));
+    const size_t cells = Padded(header.width * header.height);
+    const size_t blocks =
+        Padded(((header.width + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS) *
+               ((header.height + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS));
+    const size_t required =
+        sizeof(header) + (header.version == 1 ? header.width * header.height
+                                              : cells + blocks);
+    const char *error = NULL;
+    if (memcmp(header.magic, "RCMP", 4) != 0) {
+        error = "is not a map";
+    } else if (header.version < 1 || header.version > MAP_VERSION) {
+        error = "has an unsupported version";
+    } else if (header.width < 1 || header.width > MAP_MAX_SIZE ||
+               header.height < 1 || header.height > MAP_MAX_SIZE) {
+        error = "has an unsupported size";
+    } else if (size < required) {
+        error = "is truncated";
+    } else if (header.version > 1 &&
+               !SampleBlocks(static_cast<const uint8_t *>(mapping) +
+                                 sizeof(header),
+                             static_cast<const uint8_t *>(mapping) +
+                                 sizeof(header) + cells,
+                             header.width, header.height)) {
+        error = "has blocks that disagree with its cells";
+    }
+    if (error != NULL) {
+        fprintf(stderr, "Map %s %s\n", fileName, error);
+        munmap(mapping, size);
+        return false;
+    }
+
+    Unmap();
+    _storage.clear();
+    _mapping = mapping;
+    _mappingSize = size;
+    _cells = static_cast<const uint8_t *>(mapping) + sizeof(header);
+    _width = header.width;
+    _height = header.height;
+    _startX = header.startX;
+    _startY = header.startY;
+    _startA = header.startA;
+    if (header.version == 1) {
+        BuildBlocks();
+    } else {
+        _blockStorage.clear();
+        _blocksX = (_width + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS;
+        _blocksY = (_height + MAP_BLOCK_SIZE - 1) >> MAP_BLOCK_BITS;
+        _blocks = _cells + cells;
+    }
+    return true;
+}
+
+// Always writes the current version with its blocks, also for maps loaded
+// from version 1 files, so that they load in constant time from then on
+bool Map::Save(const char *fileName) const
+{
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Unable to create map %s\n", fileName);
+        return false;
+    }
+    MapHeader header = {{'R', 'C', 'M', 'P'},
+                        MAP_VERSION,
+                        static_cast<uint32_t>(_width),
+                        static_cast<uint32_t>(_height),
+                        _startX,
+                        _startY,
+                        _startA,
+                        0};
+    const bool ok =
+        fwrite(&header, sizeof(header), 1, file) == 1 &&
+        WritePadded(file, _cells, static_cast<size_t>(_width) * _height) &&
+        WritePadded(file, _blocks, static_cast<size_t>(_blocksX) * _blocksY);
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "Unable to write map %s\n", fileName);
+        return false;
+    }
+    return true;
+}
+
+const Map &Map::Default()
+{
+    static const Map map;
+    return map;
+}
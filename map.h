@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Largest world in either direction, in cells
+#define MAP_MAX_SIZE 4096
+// What lies outside the grid
+#define MAP_BORDER_CELL 1
+// Side of the blocks of cells the occupancy grid is made of, as a power of 2
+#define MAP_BLOCK_BITS 3
+#define MAP_BLOCK_SIZE (1 << MAP_BLOCK_BITS)
+
+// World grid, one byte per cell: 0 is empty, n is a wall showing texture
+// n - 1. Everything outside the grid is a wall with texture 0. Both casters
+// and the movement of the player read the same cells.
+//
+// Over the cells lies a coarse occupancy grid of MAP_BLOCK_SIZE square
+// blocks, one byte each: 0 when every cell of the block is inside the grid
+// and empty, so that rays can cross the block without reading its cells.
+//
+// A map file is a 32-byte little-endian header followed by the cells, row
+// by row, then the blocks, row by row, each padded to a multiple of 4 bytes:
+//   char     magic[4]     "RCMP"
+//   uint32_t version      2 (version 1 files have no blocks)
+//   uint32_t width        1 .. MAP_MAX_SIZE
+//   uint32_t height       1 .. MAP_MAX_SIZE
+//   float    startX       player start, in cells
+//   float    startY
+//   float    startA       player start angle, rad
+//   uint32_t reserved     0
+// Version 2 files are memory-mapped and read in place, so loading them takes
+// the same time whatever their size and pages are only read as rays reach
+// them; a fixed number of their blocks is checked against the cells. The
+// blocks of version 1 files are built at load time instead, which reads
+// every cell. Save always writes version 2.
+class Map
+{
+public:
+    int Width() const { return _width; }
+    int Height() const { return _height; }
+    float StartX() const { return _startX; }
+    float StartY() const { return _startY; }
+    float StartA() const { return _startA; }
+
+    uint8_t Cell(int x, int y) const
+    {
+        if (static_cast<unsigned>(x) >= static_cast<unsigned>(_width) ||
+            static_cast<unsigned>(y) >= static_cast<unsigned>(_height)) {
+            return MAP_BORDER_CELL;
+        }
+        return _cells[y * _width + x];
+    }
+
+    // Texture number the casters report for a face of a wall cell: the
+    // texture of the cell times 2, plus 1 for the faces crossed along X.
+    // Cells have a single texture, the faces only tell which side was hit.
+    static uint8_t FaceTexture(uint8_t cell, bool vertical)
+    {
+        return static_cast<uint8_t>((cell - 1) * 2 + vertical);
+    }
+
+    // Occupancy of the block (blockX, blockY), 0 if it is empty; blocks
+    // outside the grid are occupied
+    uint8_t Block(int blockX, int blockY) const
+    {
+        if (static_cast<unsigned>(blockX) >= static_cast<unsigned>(_blocksX) ||
+            static_cast<unsigned>(blockY) >= static_cast<unsigned>(_blocksY)) {
+            return 1;
+        }
+        return _blocks[blockY * _blocksX + blockX];
+    }
+    int BlocksX() const { return _blocksX; }
+
+    // Row-major cells, 4-byte aligned; the 32-bit word holding any cell can
+    // be read as a whole
+    const uint8_t *Cells() const { return _cells; }
+    // Row-major blocks, laid out like the cells
+    const uint8_t *Blocks() const { return _blocks; }
+
+    bool Load(const char *fileName);
+    bool Save(const char *fileName) const;
+
+    // The map built into the binary
+    static const Map &Default();
+
+    // The built-in map
+    Map();
+    // A map of the given row-major cells, starting the player at (x, y)
+    // facing a
+    Map(int width,
+        int height,
+        std::vector<uint8_t> cells,
+        float startX,
+        float startY,
+        float startA);
+    ~Map();
+    Map(const Map &) = delete;
+    Map &operator=(const Map &) = delete;
+
+private:
+    void Unmap();
+    void BuildBlocks();
+
+    const uint8_t *_cells;
+    const uint8_t *_blocks;
+    int _width;
+    int _height;
+    int _blocksX;
+    int _blocksY;
+    float _startX;
+    float _startY;
+    float _startA;
+    std::vector<uint8_t> _storage;       // cells of the built-in map
+    std::vector<uint8_t> _blockStorage;  // blocks built in memory
+    void *_mapping;                      // or both from the mapped file
+    size_t _mappingSize;
+};
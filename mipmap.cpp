@@ -0,0 +1,62 @@
+#include "mipmap.h"
+
+// rounded average of four texels
+static uint8_t AverageTexels(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+    return static_cast<uint8_t>((a + b + c + d + 2) >> 2);
+}
+
+// channel by channel; the unused top bit stays clear
+static uint16_t AverageTexels(uint16_t a, uint16_t b, uint16_t c, uint16_t d)
+{
+    uint16_t texel = 0;
+    for (int shift = 0; shift < TEXTURE_BITS_COLOR * 3;
+         shift += TEXTURE_BITS_COLOR) {
+        const int sum = ((a >> shift) & TEXTURE_COLOR_MASK) +
+                        ((b >> shift) & TEXTURE_COLOR_MASK) +
+                        ((c >> shift) & TEXTURE_COLOR_MASK) +
+                        ((d >> shift) & TEXTURE_COLOR_MASK);
+        texel |= ((sum + 2) >> 2) << shift;
+    }
+    return texel;
+}
+
+int MipLevelForStep(uint32_t step)
+{
+    int level = 0;
+    for (step >>= 11; step > 0 && level < MIP_LEVELS - 1; step >>= 1) {
+        level++;
+    }
+    return level;
+}
+
+template <typename Texel>
+MipChain<Texel>::MipChain(const Texel *texture)
+{
+    int size = 0;
+    for (int level = 0; level < MIP_LEVELS; level++) {
+        _offsets[level] = size;
+        size += (TEXTURE_SIZE >> level) * (TEXTURE_SIZE >> level);
+    }
+    _texels.resize(size);
+
+    Texel *top = &_texels[0];
+    for (int i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++) {
+        top[i] = texture[i];
+    }
+    for (int level = 1; level < MIP_LEVELS; level++) {
+        const int width = TEXTURE_SIZE >> level;
+        const Texel *src = &_texels[_offsets[level - 1]];
+        Texel *dst = &_texels[_offsets[level]];
+        for (int y = 0; y < width; y++) {
+            for (int x = 0; x < width; x++) {
+                const Texel *s = src + (y * 2) * (width * 2) + x * 2;
+                dst[y * width + x] =
+                    AverageTexels(s[0], s[1], s[width * 2], s[width * 2 + 1]);
+            }
+        }
+    }
+}
+
+template class MipChain<uint8_t>;
+template class MipChain<uint16_t>;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "raycaster.h"
+
+// levels from TEXTURE_SIZE x TEXTURE_SIZE down to 1 x 1
+#define MIP_LEVELS (TEXTURE_XS + 1)
+
+// Level for a column stepping through step / 1024 texels per pixel: the
+// largest one that still has a texel per pixel
+int MipLevelForStep(uint32_t step);
+
+// A wall texture and its mip chain, built once when the renderer is created.
+// Level n is TEXTURE_SIZE >> n texels wide, each texel the average of the
+// 2 x 2 texels above it. Rows are laid out like the source texture.
+template <typename Texel>
+class MipChain
+{
+public:
+    const Texel *Level(int level) const { return &_texels[_offsets[level]]; }
+
+    explicit MipChain(const Texel *texture);
+
+private:
+    std::vector<Texel> _texels;
+    int _offsets[MIP_LEVELS];
+};
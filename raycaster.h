@@ -1,23 +1,35 @@
 #pragma once
 
+#include <math.h>
 #include <stdint.h>
+#include <vector>
+#include "map.h"
 
-/* specify the precalcuated tables */
-#define TABLES_320
-
+// Default resolution, the casters accept any other one at construction
 #define SCREEN_WIDTH (uint16_t) 320
 #define SCREEN_HEIGHT (uint16_t) 256
 #define SCREEN_SCALE 2
+// Range of the runtime resolutions, the HUD does not fit on smaller screens
+#define MIN_SCREEN_SIZE 160
+#define MAX_SCREEN_SIZE 4096
 
 // Field of view
 #define FOV_X (double) (M_PI / 2)
 #define FOV_Y (double) (M_PI / 2)
+// The fixed-point tables have always been generated with tan(FOV_X / 2) set
+// to pi / 4, i.e. a slightly narrower view than the floating-point caster
+#define FIXED_FOV_X (double) (2 * atan(M_PI / 4))
 
 #define WALL_HEIGHT 1.0f
 #define INV_FACTOR \
     (float) (WALL_HEIGHT * SCREEN_WIDTH / (4.0f * tanf(FOV_X / 2)))
 //#define INV_FACTOR (float) (SCREEN_WIDTH * 95.0f / 320.0f)
 
+/* vectorized ray traversal, selected at runtime by the CPU features */
+#if defined(__GNUC__) && defined(__x86_64__)
+#define RAYCASTER_SIMD
+#endif
+
 #define LOOKUP_TBL
 #define LOOKUP8(tbl, offset) tbl[offset]
 #define LOOKUP16(tbl, offset) tbl[offset]
@@ -65,19 +77,105 @@
 #define INVERT(x) (uint8_t)((x ^ 255) + 1)
 #define ABS(x) (x < 0 ? -x : x)
 
+// A wall hit by a ray, as a ColumnHit records it
+struct WallHit {
+    uint16_t screenY;
+    uint8_t textureNo;
+    uint8_t textureX;
+    uint16_t textureY;
+    uint16_t textureStep;
+    uint32_t depth;
+};
+
+// Hit records of a frame in structure-of-arrays form, indexed by screen X
+struct ColumnHit {
+    std::vector<uint16_t> screenY;
+    std::vector<uint8_t> textureNo;  // Map::FaceTexture of the wall hit
+    std::vector<uint8_t> textureX;
+    std::vector<uint16_t> textureY;
+    std::vector<uint16_t> textureStep;
+    // perpendicular distance of the wall, 1/256 cells; TraceColumns only
+    std::vector<uint32_t> depth;
+
+    explicit ColumnHit(uint16_t width)
+        : screenY(width),
+          textureNo(width),
+          textureX(width),
+          textureY(width),
+          textureStep(width),
+          depth(width)
+    {
+    }
+
+    void Set(uint16_t x, const WallHit &hit)
+    {
+        screenY[x] = hit.screenY;
+        textureNo[x] = hit.textureNo;
+        textureX[x] = hit.textureX;
+        textureY[x] = hit.textureY;
+        textureStep[x] = hit.textureStep;
+        depth[x] = hit.depth;
+    }
+};
+
 class RayCaster
 {
 public:
-    virtual void Start(uint16_t playerX, uint16_t playerY, int16_t playerA) = 0;
+    uint16_t Width() const { return _width; }
+    uint16_t Height() const { return _height; }
+
+    const Map &GetMap() const { return *_map; }
+
+    // (playerX, playerY) in 1/256 cells, (playerA) is full circle as 1024
+    virtual void Start(uint32_t playerX, uint32_t playerY, int16_t playerA) = 0;
+    // A view in map cells and radians, like the player of a Game, the way
+    // Start takes it
+    static void ToView(float x,
+                       float y,
+                       float a,
+                       uint32_t *playerX,
+                       uint32_t *playerY,
+                       int16_t *playerA)
+    {
+        *playerX = static_cast<uint32_t>(x * 256.0f);
+        *playerY = static_cast<uint32_t>(y * 256.0f);
+        *playerA = static_cast<int16_t>(a / (2.0f * M_PI) * 1024.0f);
+    }
 
     virtual void Trace(uint16_t screenX,
-                       uint8_t *screenY,
+                       uint16_t *screenY,
                        uint8_t *textureNo,
                        uint8_t *textureX,
                        uint16_t *textureY,
                        uint16_t *textureStep) = 0;
-
-    RayCaster(){};
-
-    ~RayCaster(){};
+    // Walk the ray of screenX through its first maxHits walls in a single
+    // pass, nearest first, for see-through rendering, and return how many
+    // were stored in hits; entries past that are left untouched. Outside the
+    // map every cell is a wall, so rays only stop short of maxHits when they
+    // do not move at all, which the float caster finds at a distance of 0.
+    virtual int TraceWalls(uint16_t screenX, WallHit *hits, int maxHits) = 0;
+
+    // Trace columns [first, first + count) into out, one record per column
+    virtual void TraceColumns(uint16_t first,
+                              uint16_t count,
+                              ColumnHit *out) = 0;
+
+    // Projection of the walls, for what is drawn around them: a wall d cells
+    // away is 2 * WallScale() / d pixels tall, and column x looks along
+    // (x - width / 2) / (width / 2) * TanHalfFov() off the view direction
+    virtual float WallScale() const = 0;
+    virtual float TanHalfFov() const = 0;
+
+    // Create an independent caster of the same kind, e.g. one per thread
+    virtual RayCaster *Clone() const = 0;
+
+    RayCaster(uint16_t width, uint16_t height, const Map &map)
+        : _width(width), _height(height), _map(&map){};
+
+    virtual ~RayCaster(){};
+
+protected:
+    uint16_t _width;
+    uint16_t _height;
+    const Map *_map;
 };
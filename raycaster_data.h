@@ -1,34 +1,5 @@
 #pragma once
 
-const uint8_t LOOKUP_TBL g_map[] = {
-    0b00000000, 0b10000000, 0b00000000, 0b00000000, 0b01111010, 0b10111111,
-    0b11111111, 0b00000000, 0b00111000, 0b10100000, 0b00001000, 0b01001100,
-    0b01000001, 0b00000100, 0b00100100, 0b00001100, 0b00000000, 0b10001010,
-    0b00000010, 0b01011100, 0b10000001, 0b11000100, 0b00000110, 0b00001100,
-    0b00000000, 0b11010010, 0b00010000, 0b00001100, 0b01001100, 0b10010000,
-    0b00000000, 0b00111100,
-
-    0b00100011, 0b10100100, 0b00000100, 0b00001100, 0b00000000, 0b11000001,
-    0b10001000, 0b00001100, 0b00110000, 0b10011100, 0b00111000, 0b01111100,
-    0b00000011, 0b00000000, 0b00000000, 0b00001100, 0b00011111, 0b11111110,
-    0b11111111, 0b11111100, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000,
-
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000,
-
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
-    0b00000000, 0b00000000};
-
 const uint32_t LOOKUP_TBL g_map32[] = {
     0b00000000000000000000000000000000, 0b00010000000000000000000000000000,
     0b00100000000000000000000000000000, 0b00000000000000000000000000000000,
@@ -1,22 +1,21 @@
 // fixed-point implementation
 
 #include "raycaster_fixed.h"
-#include "raycaster_data.h"
 #include "raycaster_tables.h"
 
 // (v * f) >> 8
-uint16_t RayCasterFixed::MulU(uint8_t v, uint16_t f)
+uint32_t RayCasterFixed::MulU(uint8_t v, uint32_t f)
 {
-    const uint8_t f_h = f >> 8;
+    const uint32_t f_h = f >> 8;
     const uint8_t f_l = f % 256;
-    const uint16_t hm = v * f_h;
+    const uint32_t hm = v * f_h;
     const uint16_t lm = v * f_l;
     return hm + (lm >> 8);
 }
 
-int16_t RayCasterFixed::MulS(uint8_t v, int16_t f)
+int32_t RayCasterFixed::MulS(uint8_t v, int32_t f)
 {
-    const uint16_t uf = MulU(v, static_cast<uint16_t>(ABS(f)));
+    const uint32_t uf = MulU(v, static_cast<uint32_t>(ABS(f)));
     if (f < 0) {
         return ~uf;
     }
@@ -58,171 +57,204 @@ inline int16_t RayCasterFixed::AbsTan(uint8_t quarter,
     return LOOKUP16(lookupTable, angle);
 }
 
-inline bool RayCasterFixed::IsWall(uint8_t tileX, uint8_t tileY)
+// cell at (tileX, tileY), 0 if it is empty
+inline uint8_t RayCasterFixed::IsWall(const Map &map,
+                                      int32_t tileX,
+                                      int32_t tileY)
 {
-    if (tileX > MAP_X - 1 || tileY > MAP_Y - 1) {
-        return true;
-    }
-    return LOOKUP8(g_map, (tileX >> 3) + (tileY << (MAP_XS - 3))) &
-           (1 << (8 - (tileX & 0x7)));
+    return map.Cell(tileX, tileY);
+}
+
+bool RayCasterFixed::InEmptyBlock(const Map &map, const RayState &ray)
+{
+    return map.Block(ray.tileX >> MAP_BLOCK_BITS,
+                     ray.tileY >> MAP_BLOCK_BITS) == 0;
 }
 
-void RayCasterFixed::LookupHeight(uint16_t distance,
-                                  uint8_t *height,
-                                  uint16_t *step)
+void RayCasterFixed::LookupHeight(uint32_t distance,
+                                  uint16_t *height,
+                                  uint16_t *step) const
 {
     if (distance >= 256) {
-        const uint16_t ds = distance >> 3;
+        const uint32_t ds = distance >> 3;
         if (ds >= 256) {
-            *height = LOOKUP8(g_farHeight, 255) - 1;
-            *step = LOOKUP16(g_farStep, 255);
+            *height = LOOKUP16(_tables->farHeight, 255) - 1;
+            *step = LOOKUP16(_tables->farStep, 255);
+        } else {
+            *height = LOOKUP16(_tables->farHeight, ds);
+            *step = LOOKUP16(_tables->farStep, ds);
         }
-        *height = LOOKUP8(g_farHeight, ds);
-        *step = LOOKUP16(g_farStep, ds);
     } else {
-        *height = LOOKUP8(g_nearHeight, distance);
-        *step = LOOKUP16(g_nearStep, distance);
+        *height = LOOKUP16(_tables->nearHeight, distance);
+        *step = LOOKUP16(_tables->nearStep, distance);
     }
 }
 
-void RayCasterFixed::CalculateDistance(uint16_t rayX,
-                                       uint16_t rayY,
-                                       uint16_t rayA,
-                                       int16_t *deltaX,
-                                       int16_t *deltaY,
-                                       uint8_t *textureNo,
-                                       uint8_t *textureX)
+void RayCasterFixed::SetupRay(uint32_t rayX,
+                              uint32_t rayY,
+                              uint16_t rayA,
+                              RayState *ray)
 {
-    int8_t tileStepX;
-    int8_t tileStepY;
-    int16_t interceptX = rayX;
-    int16_t interceptY = rayY;
-
     const uint8_t quarter = rayA >> 8;
     const uint8_t angle = rayA % 256;
     const uint8_t offsetX = rayX % 256;
     const uint8_t offsetY = rayY % 256;
 
-    uint8_t tileX = rayX >> 8;
-    uint8_t tileY = rayY >> 8;
-    int16_t hitX;
-    int16_t hitY;
+    ray->interceptX = rayX;
+    ray->interceptY = rayY;
+    ray->stepX = 0;
+    ray->stepY = 0;
+    ray->tileX = rayX >> 8;
+    ray->tileY = rayY >> 8;
 
     if (angle == 0) {
         switch (quarter % 2) {
         case 0:
-            tileStepX = 0;
-            tileStepY = quarter == 0 ? 1 : -1;
-            if (tileStepY == 1) {
-                interceptY -= 256;
-            }
-            for (;;) {
-                tileY += tileStepY;
-                if (IsWall(tileX, tileY)) {
-                    goto HorizontalHit;
-                }
+            ray->tileStepX = 0;
+            ray->tileStepY = quarter == 0 ? 1 : -1;
+            if (ray->tileStepY == 1) {
+                ray->interceptY -= 256;
             }
             break;
         case 1:
-            tileStepY = 0;
-            tileStepX = quarter == 1 ? 1 : -1;
-            if (tileStepX == 1) {
-                interceptX -= 256;
-            }
-            for (;;) {
-                tileX += tileStepX;
-                if (IsWall(tileX, tileY)) {
-                    goto VerticalHit;
-                }
+            ray->tileStepY = 0;
+            ray->tileStepX = quarter == 1 ? 1 : -1;
+            if (ray->tileStepX == 1) {
+                ray->interceptX -= 256;
             }
             break;
         }
+        return;
+    }
+
+    switch (quarter) {
+    case 0:
+    case 1:
+        ray->tileStepX = 1;
+        ray->interceptY += MulTan(offsetX, true, quarter, angle, g_cotan);
+        ray->interceptX -= 256;
+        ray->stepX = AbsTan(quarter, angle, g_tan);
+        break;
+    case 2:
+    case 3:
+        ray->tileStepX = -1;
+        ray->interceptY -= MulTan(offsetX, false, quarter, angle, g_cotan);
+        ray->stepX = -AbsTan(quarter, angle, g_tan);
+        break;
+    }
+
+    switch (quarter) {
+    case 0:
+    case 3:
+        ray->tileStepY = 1;
+        ray->interceptX += MulTan(offsetY, true, quarter, angle, g_tan);
+        ray->interceptY -= 256;
+        ray->stepY = AbsTan(quarter, angle, g_cotan);
+        break;
+    case 1:
+    case 2:
+        ray->tileStepY = -1;
+        ray->interceptX -= MulTan(offsetY, false, quarter, angle, g_tan);
+        ray->stepY = -AbsTan(quarter, angle, g_cotan);
+        break;
+    }
+}
+
+void RayCasterFixed::FinishRay(uint32_t rayX,
+                               uint32_t rayY,
+                               const RayState &ray,
+                               bool verticalHit,
+                               uint8_t cell,
+                               int32_t *deltaX,
+                               int32_t *deltaY,
+                               uint8_t *textureNo,
+                               uint8_t *textureX)
+{
+    int32_t hitX;
+    int32_t hitY;
+
+    if (verticalHit) {
+        hitX = (ray.tileX << 8) + (ray.tileStepX == -1 ? 256 : 0);
+        hitY = ray.interceptY + (ray.tileStepY == 1 ? 256 : 0);
+        *textureX = ray.interceptY & 0xFF;
     } else {
-        int16_t stepX;
-        int16_t stepY;
+        hitX = ray.interceptX + (ray.tileStepX == 1 ? 256 : 0);
+        hitY = (ray.tileY << 8) + (ray.tileStepY == -1 ? 256 : 0);
+        *textureX = ray.interceptX & 0xFF;
+    }
+    *textureNo = Map::FaceTexture(cell, verticalHit);
+    *deltaX = hitX - static_cast<int32_t>(rayX);
+    *deltaY = hitY - static_cast<int32_t>(rayY);
+}
 
-        switch (quarter) {
-        case 0:
-        case 1:
-            tileStepX = 1;
-            interceptY += MulTan(offsetX, true, quarter, angle, g_cotan);
-            interceptX -= 256;
-            stepX = AbsTan(quarter, angle, g_tan);
-            break;
-        case 2:
-        case 3:
-            tileStepX = -1;
-            interceptY -= MulTan(offsetX, false, quarter, angle, g_cotan);
-            stepX = -AbsTan(quarter, angle, g_tan);
-            break;
-        }
+void RayCasterFixed::CalculateDistance(const Map &map,
+                                       uint32_t rayX,
+                                       uint32_t rayY,
+                                       uint16_t rayA,
+                                       int32_t *deltaX,
+                                       int32_t *deltaY,
+                                       uint8_t *textureNo,
+                                       uint8_t *textureX)
+{
+    RayState ray;
+    bool verticalHit;
+    uint8_t cell;
 
-        switch (quarter) {
-        case 0:
-        case 3:
-            tileStepY = 1;
-            interceptX += MulTan(offsetY, true, quarter, angle, g_tan);
-            interceptY -= 256;
-            stepY = AbsTan(quarter, angle, g_cotan);
-            break;
-        case 1:
-        case 2:
-            tileStepY = -1;
-            interceptX -= MulTan(offsetY, false, quarter, angle, g_tan);
-            stepY = -AbsTan(quarter, angle, g_cotan);
-            break;
-        }
+    SetupRay(rayX, rayY, rayA, &ray);
 
+    if (ray.tileStepX == 0) {
+        for (;;) {
+            ray.tileY += ray.tileStepY;
+            if ((cell = IsWall(map, ray.tileX, ray.tileY)) != 0) {
+                goto HorizontalHit;
+            }
+        }
+    } else if (ray.tileStepY == 0) {
         for (;;) {
-            while ((tileStepY == 1 && (interceptY >> 8 < tileY)) ||
-                   (tileStepY == -1 && (interceptY >> 8 >= tileY))) {
-                tileX += tileStepX;
-                if (IsWall(tileX, tileY)) {
-                    goto VerticalHit;
-                }
-                interceptY += stepY;
+            ray.tileX += ray.tileStepX;
+            if ((cell = IsWall(map, ray.tileX, ray.tileY)) != 0) {
+                goto VerticalHit;
             }
-            while ((tileStepX == 1 && (interceptX >> 8 < tileX)) ||
-                   (tileStepX == -1 && (interceptX >> 8 >= tileX))) {
-                tileY += tileStepY;
-                if (IsWall(tileX, tileY)) {
-                    goto HorizontalHit;
-                }
-                interceptX += stepX;
+        }
+    }
+
+    for (;;) {
+        while ((ray.tileStepY == 1 && (ray.interceptY >> 8 < ray.tileY)) ||
+               (ray.tileStepY == -1 && (ray.interceptY >> 8 >= ray.tileY))) {
+            ray.tileX += ray.tileStepX;
+            if ((cell = IsWall(map, ray.tileX, ray.tileY)) != 0) {
+                goto VerticalHit;
             }
+            ray.interceptY += ray.stepY;
+        }
+        while ((ray.tileStepX == 1 && (ray.interceptX >> 8 < ray.tileX)) ||
+               (ray.tileStepX == -1 && (ray.interceptX >> 8 >= ray.tileX))) {
+            ray.tileY += ray.tileStepY;
+            if ((cell = IsWall(map, ray.tileX, ray.tileY)) != 0) {
+                goto HorizontalHit;
+            }
+            ray.interceptX += ray.stepX;
         }
     }
 
 HorizontalHit:
-    hitX = interceptX + (tileStepX == 1 ? 256 : 0);
-    hitY = (tileY << 8) + (tileStepY == -1 ? 256 : 0);
-    *textureNo = 0;
-    *textureX = interceptX & 0xFF;
+    verticalHit = false;
     goto WallHit;
 
 VerticalHit:
-    hitX = (tileX << 8) + (tileStepX == -1 ? 256 : 0);
-    hitY = interceptY + (tileStepY == 1 ? 256 : 0);
-    *textureNo = 1;
-    *textureX = interceptY & 0xFF;
+    verticalHit = true;
     goto WallHit;
 
 WallHit:
-    *deltaX = hitX - rayX;
-    *deltaY = hitY - rayY;
+    FinishRay(rayX, rayY, ray, verticalHit, cell, deltaX, deltaY, textureNo,
+              textureX);
 }
 
-// (playerX, playerY) is 8 box coordinate bits, 8 inside coordinate bits
-// (playerA) is full circle as 1024
-void RayCasterFixed::Trace(uint16_t screenX,
-                           uint8_t *screenY,
-                           uint8_t *textureNo,
-                           uint8_t *textureX,
-                           uint16_t *textureY,
-                           uint16_t *textureStep)
+// absolute angle of the ray through a screen column, full circle as 1024
+uint16_t RayCasterFixed::RayAngle(uint16_t screenX) const
 {
-    uint16_t rayAngle =
-        static_cast<uint16_t>(_playerA + LOOKUP16(g_deltaAngle, screenX));
+    uint16_t rayAngle = static_cast<uint16_t>(
+        _playerA + LOOKUP16(_tables->deltaAngle, screenX));
 
     // neutralize artefacts around edges
     switch (rayAngle % 256) {
@@ -235,15 +267,30 @@ void RayCasterFixed::Trace(uint16_t screenX,
         rayAngle++;
         break;
     }
-    rayAngle %= 1024;
+    return rayAngle % FIXED_ANGLES;
+}
 
-    int16_t deltaX;
-    int16_t deltaY;
-    CalculateDistance(_playerX, _playerY, rayAngle, &deltaX, &deltaY, textureNo,
-                      textureX);
+// the walk of the ray at rayA from the player, from the cache when it holds
+const RayCasterFixed::AngleHit &RayCasterFixed::LookupHit(uint16_t rayA)
+{
+    AngleHit &hit = _angleHits[rayA];
+    if (hit.generation != _hitGeneration) {
+        CalculateDistance(*_map, _playerX, _playerY, rayA, &hit.deltaX,
+                          &hit.deltaY, &hit.textureNo, &hit.textureX);
+        hit.generation = _hitGeneration;
+    }
+    return hit;
+}
 
+// returns the perpendicular distance of the wall
+uint32_t RayCasterFixed::ProjectWall(int32_t deltaX,
+                                     int32_t deltaY,
+                                     uint16_t *screenY,
+                                     uint16_t *textureY,
+                                     uint16_t *textureStep) const
+{
     // distance = deltaY * cos(playerA) + deltaX * sin(playerA)
-    int16_t distance = 0;
+    int32_t distance = 0;
     if (_playerA == 0) {
         distance += deltaY;
     } else if (_playerA == 512) {
@@ -283,25 +330,187 @@ void RayCasterFixed::Trace(uint16_t screenX,
             distance -= MulS(LOOKUP8(g_sin, INVERT(_viewAngle)), deltaX);
             break;
         }
-    if (distance >= MIN_DIST) {
+    const int minDist = _tables->minDist;
+    if (distance >= minDist) {
         *textureY = 0;
-        LookupHeight((distance - MIN_DIST) >> 2, screenY, textureStep);
+        LookupHeight((distance - minDist) >> 2, screenY, textureStep);
     } else {
-        *screenY = SCREEN_HEIGHT >> 1;
-        *textureY = LOOKUP16(g_overflowOffset, distance);
-        *textureStep = LOOKUP16(g_overflowStep, distance);
+        if (distance < 0) {
+            distance = 0;
+        }
+        *screenY = _height >> 1;
+        *textureY = LOOKUP16(_tables->overflowOffset, distance);
+        *textureStep = LOOKUP16(_tables->overflowStep, distance);
     }
+    return distance;
 }
 
-void RayCasterFixed::Start(uint16_t playerX, uint16_t playerY, int16_t playerA)
+// (playerX, playerY) is cell coordinate bits above 8 inside coordinate bits
+// (playerA) is full circle as 1024
+void RayCasterFixed::Trace(uint16_t screenX,
+                           uint16_t *screenY,
+                           uint8_t *textureNo,
+                           uint8_t *textureX,
+                           uint16_t *textureY,
+                           uint16_t *textureStep)
+{
+    const AngleHit &hit = LookupHit(RayAngle(screenX));
+    *textureNo = hit.textureNo;
+    *textureX = hit.textureX;
+    ProjectWall(hit.deltaX, hit.deltaY, screenY, textureY, textureStep);
+}
+
+int RayCasterFixed::TraceWalls(uint16_t screenX, WallHit *hits, int maxHits)
+{
+    if (maxHits <= 0) {
+        return 0;
+    }
+
+    RayState ray;
+    int found = 0;
+    // The walk of CalculateDistance, where every wall but the last one
+    // wanted is stepped through like an empty cell. Returns true once the
+    // last one is stored. Every wall the walk reaches is a hit: a depth of 0
+    // is a wall the player stands against, clamped from just below 0, which
+    // TraceColumns draws as well.
+    auto store = [&](bool verticalHit, uint8_t cell) {
+        int32_t deltaX;
+        int32_t deltaY;
+        WallHit hit;
+        FinishRay(_playerX, _playerY, ray, verticalHit, cell, &deltaX,
+                  &deltaY, &hit.textureNo, &hit.textureX);
+        hit.depth = ProjectWall(deltaX, deltaY, &hit.screenY, &hit.textureY,
+                                &hit.textureStep);
+        hits[found++] = hit;
+        return found == maxHits;
+    };
+    uint8_t cell;
+
+    SetupRay(_playerX, _playerY, RayAngle(screenX), &ray);
+
+    if (ray.tileStepX == 0) {
+        for (;;) {
+            ray.tileY += ray.tileStepY;
+            if ((cell = IsWall(*_map, ray.tileX, ray.tileY)) != 0 &&
+                store(false, cell)) {
+                return found;
+            }
+        }
+    } else if (ray.tileStepY == 0) {
+        for (;;) {
+            ray.tileX += ray.tileStepX;
+            if ((cell = IsWall(*_map, ray.tileX, ray.tileY)) != 0 &&
+                store(true, cell)) {
+                return found;
+            }
+        }
+    }
+
+    for (;;) {
+        while ((ray.tileStepY == 1 && (ray.interceptY >> 8 < ray.tileY)) ||
+               (ray.tileStepY == -1 && (ray.interceptY >> 8 >= ray.tileY))) {
+            ray.tileX += ray.tileStepX;
+            if ((cell = IsWall(*_map, ray.tileX, ray.tileY)) != 0 &&
+                store(true, cell)) {
+                return found;
+            }
+            ray.interceptY += ray.stepY;
+        }
+        while ((ray.tileStepX == 1 && (ray.interceptX >> 8 < ray.tileX)) ||
+               (ray.tileStepX == -1 && (ray.interceptX >> 8 >= ray.tileX))) {
+            ray.tileY += ray.tileStepY;
+            if ((cell = IsWall(*_map, ray.tileX, ray.tileY)) != 0 &&
+                store(false, cell)) {
+                return found;
+            }
+            ray.interceptX += ray.stepX;
+        }
+    }
+}
+
+void RayCasterFixed::TraceColumns(uint16_t first,
+                                  uint16_t count,
+                                  ColumnHit *out)
+{
+    // any screen width is traced in batches of bounded size
+    const uint16_t batch = 256;
+    uint16_t rayA[batch];
+    // angles of the batch missing from the cache, each one once
+    uint16_t missA[batch];
+    int32_t deltaX[batch];
+    int32_t deltaY[batch];
+    uint8_t textureNo[batch];
+    uint8_t textureX[batch];
+
+    for (uint16_t done = 0; done < count; done += batch) {
+        const uint16_t start = first + done;
+        const uint16_t n = count - done < batch ? count - done : batch;
+        int missing = 0;
+        for (uint16_t i = 0; i < n; i++) {
+            rayA[i] = RayAngle(start + i);
+            AngleHit &hit = _angleHits[rayA[i]];
+            if (hit.generation != _hitGeneration) {
+                hit.generation = _hitGeneration;
+                missA[missing++] = rayA[i];
+            }
+        }
+        CalculateDistances(*_map, _playerX, _playerY, missA, missing, deltaX,
+                           deltaY, textureNo, textureX);
+        for (int i = 0; i < missing; i++) {
+            AngleHit &hit = _angleHits[missA[i]];
+            hit.deltaX = deltaX[i];
+            hit.deltaY = deltaY[i];
+            hit.textureNo = textureNo[i];
+            hit.textureX = textureX[i];
+        }
+        for (uint16_t i = 0; i < n; i++) {
+            const uint16_t x = start + i;
+            const AngleHit &hit = _angleHits[rayA[i]];
+            out->textureNo[x] = hit.textureNo;
+            out->textureX[x] = hit.textureX;
+            out->depth[x] =
+                ProjectWall(hit.deltaX, hit.deltaY, &out->screenY[x],
+                            &out->textureY[x], &out->textureStep[x]);
+        }
+    }
+}
+
+void RayCasterFixed::Start(uint32_t playerX, uint32_t playerY, int16_t playerA)
 {
     _viewQuarter = playerA >> 8;
     _viewAngle = playerA % 256;
     _playerX = playerX;
     _playerY = playerY;
     _playerA = playerA;
+    if (playerX != _hitX || playerY != _hitY) {
+        _hitX = playerX;
+        _hitY = playerY;
+        // a generation that wrapped around could match stale hits
+        if (++_hitGeneration == 0) {
+            for (AngleHit &hit : _angleHits) {
+                hit.generation = 0;
+            }
+            _hitGeneration = 1;
+        }
+    }
 }
 
-RayCasterFixed::RayCasterFixed() : RayCaster() {}
+RayCaster *RayCasterFixed::Clone() const
+{
+    return new RayCasterFixed(*this);
+}
+
+RayCasterFixed::RayCasterFixed(uint16_t width,
+                               uint16_t height,
+                               double fov,
+                               const Map &map)
+    : RayCaster(width, height, map),
+      _tables(std::make_shared<ScreenTables>(width, height, fov)),
+      _angleHits(FIXED_ANGLES),
+      _hitX(0),
+      _hitY(0),
+      _hitGeneration(1)
+{
+}
 
 RayCasterFixed::~RayCasterFixed() {}
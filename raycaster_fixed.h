@@ -1,38 +1,148 @@
 #pragma once
+#include <memory>
+#include <vector>
 #include "raycaster.h"
+#include "screen_tables.h"
+
+// ray angles of the fixed-point caster, full circle
+#define FIXED_ANGLES 1024
 
 class RayCasterFixed : public RayCaster
 {
 public:
-    void Start(uint16_t playerX, uint16_t playerY, int16_t playerA);
+    void Start(uint32_t playerX, uint32_t playerY, int16_t playerA);
     void Trace(uint16_t screenX,
-               uint8_t *screenY,
+               uint16_t *screenY,
                uint8_t *textureNo,
                uint8_t *textureX,
                uint16_t *textureY,
                uint16_t *textureStep);
+    int TraceWalls(uint16_t screenX, WallHit *hits, int maxHits);
+    void TraceColumns(uint16_t first, uint16_t count, ColumnHit *out);
+    // distances are 8.8 fixed point
+    float WallScale() const { return _tables->invFactor / 256.0f; }
+    float TanHalfFov() const { return _tables->tanHalf; }
+    RayCaster *Clone() const;
 
-    RayCasterFixed();
+    RayCasterFixed(uint16_t width = SCREEN_WIDTH,
+                   uint16_t height = SCREEN_HEIGHT,
+                   double fov = FIXED_FOV_X,
+                   const Map &map = Map::Default());
     ~RayCasterFixed();
 
 private:
-    uint16_t _playerX;
-    uint16_t _playerY;
+    friend struct RayCasterFixedTest;
+
+    // shared with the clones, the tables only depend on the screen
+    std::shared_ptr<const ScreenTables> _tables;
+    uint32_t _playerX;
+    uint32_t _playerY;
     int16_t _playerA;
     uint8_t _viewQuarter;
     uint8_t _viewAngle;
 
-    static void CalculateDistance(uint16_t rayX,
-                                  uint16_t rayY,
+    // Where the ray of every absolute angle hits from (_hitX, _hitY), filled
+    // in as the angles are traced. The walk of a ray only depends on the
+    // position, so a view turning in place looks its rays up instead of
+    // walking them again; moving starts a new generation, which empties it.
+    struct AngleHit {
+        int32_t deltaX;
+        int32_t deltaY;
+        uint8_t textureNo;
+        uint8_t textureX;
+        uint32_t generation;  // filled in generation _hitGeneration
+    };
+    std::vector<AngleHit> _angleHits;
+    uint32_t _hitX;
+    uint32_t _hitY;
+    uint32_t _hitGeneration;
+
+    // State of the grid walk of a single ray; positions are 8 fraction bits
+    // over enough integer bits for MAP_MAX_SIZE cells
+    struct RayState {
+        int32_t interceptX;
+        int32_t interceptY;
+        int16_t stepX;
+        int16_t stepY;
+        int32_t tileX;
+        int32_t tileY;
+        int8_t tileStepX;
+        int8_t tileStepY;
+    };
+
+    uint16_t RayAngle(uint16_t screenX) const;
+    const AngleHit &LookupHit(uint16_t rayA);
+    uint32_t ProjectWall(int32_t deltaX,
+                         int32_t deltaY,
+                         uint16_t *screenY,
+                         uint16_t *textureY,
+                         uint16_t *textureStep) const;
+    static void SetupRay(uint32_t rayX,
+                         uint32_t rayY,
+                         uint16_t rayA,
+                         RayState *ray);
+    static void FinishRay(uint32_t rayX,
+                          uint32_t rayY,
+                          const RayState &ray,
+                          bool verticalHit,
+                          uint8_t cell,
+                          int32_t *deltaX,
+                          int32_t *deltaY,
+                          uint8_t *textureNo,
+                          uint8_t *textureX);
+    static void CalculateDistance(const Map &map,
+                                  uint32_t rayX,
+                                  uint32_t rayY,
                                   uint16_t rayA,
-                                  int16_t *deltaX,
-                                  int16_t *deltaY,
+                                  int32_t *deltaX,
+                                  int32_t *deltaY,
                                   uint8_t *textureNo,
                                   uint8_t *textureX);
-    static void LookupHeight(uint16_t distance,
-                             uint8_t *height,
-                             uint16_t *step);
-    static bool IsWall(uint8_t tileX, uint8_t tileY);
+    // CalculateDistance for count rays from the same origin, several rays
+    // at a time when the CPU supports it (raycaster_fixed_simd.cpp)
+    static void CalculateDistances(const Map &map,
+                                   uint32_t rayX,
+                                   uint32_t rayY,
+                                   const uint16_t *rayA,
+                                   int count,
+                                   int32_t *deltaX,
+                                   int32_t *deltaY,
+                                   uint8_t *textureNo,
+                                   uint8_t *textureX);
+    static void CalculateDistancesScalar(const Map &map,
+                                         uint32_t rayX,
+                                         uint32_t rayY,
+                                         const uint16_t *rayA,
+                                         int count,
+                                         int32_t *deltaX,
+                                         int32_t *deltaY,
+                                         uint8_t *textureNo,
+                                         uint8_t *textureX);
+#ifdef RAYCASTER_SIMD
+    static void CalculateDistancesAVX2(const Map &map,
+                                       uint32_t rayX,
+                                       uint32_t rayY,
+                                       const uint16_t *rayA,
+                                       int count,
+                                       int32_t *deltaX,
+                                       int32_t *deltaY,
+                                       uint8_t *textureNo,
+                                       uint8_t *textureX);
+    static void CalculateDistancesAVX512(const Map &map,
+                                         uint32_t rayX,
+                                         uint32_t rayY,
+                                         const uint16_t *rayA,
+                                         int count,
+                                         int32_t *deltaX,
+                                         int32_t *deltaY,
+                                         uint8_t *textureNo,
+                                         uint8_t *textureX);
+#endif
+    void LookupHeight(uint32_t distance,
+                      uint16_t *height,
+                      uint16_t *step) const;
+    static uint8_t IsWall(const Map &map, int32_t tileX, int32_t tileY);
+    static bool InEmptyBlock(const Map &map, const RayState &ray);
     static int16_t MulTan(uint8_t value,
                           bool inverse,
                           uint8_t quarter,
@@ -41,6 +151,6 @@ private:
     static int16_t AbsTan(uint8_t quarter,
                           uint8_t angle,
                           const uint16_t *lookupTable);
-    static uint16_t MulU(uint8_t v, uint16_t f);
-    static int16_t MulS(uint8_t v, int16_t f);
+    static uint32_t MulU(uint8_t v, uint32_t f);
+    static int32_t MulS(uint8_t v, int32_t f);
 };
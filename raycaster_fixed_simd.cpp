@@ -0,0 +1,540 @@
+// vectorized fixed-point ray traversal
+//
+// The kernels walk 8 (AVX2) or 16 (AVX-512) rays in lockstep and produce
+// exactly what CalculateDistance produces for each of them: every lane
+// remembers which of the two inner loops of the scalar walk it is in, and
+// idle lanes are masked off. Map cells are bytes, gathered as the aligned
+// 32-bit word that holds them.
+//
+// On maps too large for the cache, a lane inside an empty block of the map
+// takes the steps its loop allows up to the edge of the block at once and
+// reads no cell on the way; the occupancy of a block is only gathered when
+// a lane enters it. A run of steps is taken at once only when the loop
+// condition holds for its first and last step, and the condition is linear
+// in the number of steps, so the lane ends where the walk cell by cell
+// would.
+
+#include "raycaster_fixed.h"
+
+#ifdef RAYCASTER_SIMD
+#include <immintrin.h>
+#endif
+
+void RayCasterFixed::CalculateDistancesScalar(const Map &map,
+                                              uint32_t rayX,
+                                              uint32_t rayY,
+                                              const uint16_t *rayA,
+                                              int count,
+                                              int32_t *deltaX,
+                                              int32_t *deltaY,
+                                              uint8_t *textureNo,
+                                              uint8_t *textureX)
+{
+    for (int i = 0; i < count; i++) {
+        CalculateDistance(map, rayX, rayY, rayA[i], &deltaX[i], &deltaY[i],
+                          &textureNo[i], &textureX[i]);
+    }
+}
+
+#ifdef RAYCASTER_SIMD
+
+// Below this many cells the grid stays in the cache and reading every cell
+// the walk crosses is cheaper than keeping track of the blocks
+#define BLOCK_WALK_MIN_CELLS (1 << 23)
+
+static inline bool UseBlockWalk(const Map &map)
+{
+    return (int64_t) map.Width() * map.Height() >= BLOCK_WALK_MIN_CELLS;
+}
+
+// Byte at index of a grid of the map, from the aligned word holding it
+__attribute__((target("avx2"))) static inline __m256i GatherBytes(
+    const int *words,
+    __m256i index,
+    __m256i mask)
+{
+    const __m256i word = _mm256_mask_i32gather_epi32(
+        _mm256_setzero_si256(), words, _mm256_srli_epi32(index, 2), mask, 4);
+    const __m256i shift = _mm256_slli_epi32(
+        _mm256_and_si256(index, _mm256_set1_epi32(3)), 3);
+    return _mm256_and_si256(_mm256_srlv_epi32(word, shift),
+                            _mm256_set1_epi32(0xFF));
+}
+
+__attribute__((target("avx2"))) void RayCasterFixed::CalculateDistancesAVX2(
+    const Map &map,
+    uint32_t rayX,
+    uint32_t rayY,
+    const uint16_t *rayA,
+    int count,
+    int32_t *deltaX,
+    int32_t *deltaY,
+    uint8_t *textureNo,
+    uint8_t *textureX)
+{
+    const int *cells = reinterpret_cast<const int *>(map.Cells());
+    const int *blocks = reinterpret_cast<const int *>(map.Blocks());
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i blockMask = _mm256_set1_epi32(MAP_BLOCK_SIZE - 1);
+    const __m256i width = _mm256_set1_epi32(map.Width());
+    const __m256i blocksX = _mm256_set1_epi32(map.BlocksX());
+    const __m256i border = _mm256_set1_epi32(MAP_BORDER_CELL);
+    const __m256i lastX = _mm256_set1_epi32(map.Width() - 1);
+    const __m256i lastY = _mm256_set1_epi32(map.Height() - 1);
+    const bool blockWalk = UseBlockWalk(map);
+
+    for (int base = 0; base < count; base += 8) {
+        const int lanes = count - base < 8 ? count - base : 8;
+        RayState rays[8];
+        alignas(32) int32_t lane[9][8];
+
+        // idle lanes repeat the last ray and finish together with it
+        for (int i = 0; i < 8; i++) {
+            RayState &ray = rays[i];
+            SetupRay(rayX, rayY, rayA[base + (i < lanes ? i : lanes - 1)],
+                     &ray);
+            lane[0][i] = ray.tileX;
+            lane[1][i] = ray.tileY;
+            lane[2][i] = ray.interceptX;
+            lane[3][i] = ray.interceptY;
+            lane[4][i] = ray.stepX;
+            lane[5][i] = ray.stepY;
+            lane[6][i] = ray.tileStepX;
+            lane[7][i] = ray.tileStepY;
+            lane[8][i] = blockWalk && InEmptyBlock(map, ray) ? -1 : 0;
+        }
+        __m256i tileX = _mm256_load_si256((const __m256i *) lane[0]);
+        __m256i tileY = _mm256_load_si256((const __m256i *) lane[1]);
+        __m256i interceptX = _mm256_load_si256((const __m256i *) lane[2]);
+        __m256i interceptY = _mm256_load_si256((const __m256i *) lane[3]);
+        const __m256i stepX = _mm256_load_si256((const __m256i *) lane[4]);
+        const __m256i stepY = _mm256_load_si256((const __m256i *) lane[5]);
+        const __m256i tileStepX = _mm256_load_si256((const __m256i *) lane[6]);
+        const __m256i tileStepY = _mm256_load_si256((const __m256i *) lane[7]);
+        __m256i emptyBlock = _mm256_load_si256((const __m256i *) lane[8]);
+
+        // rays along an axis only ever step along that axis
+        const __m256i alongX = _mm256_cmpeq_epi32(tileStepY, zero);
+        const __m256i alongY = _mm256_cmpeq_epi32(tileStepX, zero);
+        const __m256i upX = _mm256_cmpeq_epi32(tileStepX, one);
+        const __m256i downX = _mm256_cmpeq_epi32(tileStepX, ones);
+        const __m256i upY = _mm256_cmpeq_epi32(tileStepY, one);
+        const __m256i downY = _mm256_cmpeq_epi32(tileStepY, ones);
+        // cells ahead in a block are the low tile bits, flipped going up
+        const __m256i flipX = _mm256_and_si256(upX, blockMask);
+        const __m256i flipY = _mm256_and_si256(upY, blockMask);
+
+        __m256i active = ones;
+        __m256i inLoopY = zero;
+        __m256i vertical = zero;
+        __m256i hitCell = zero;
+        while (!_mm256_testz_si256(active, active)) {
+            const __m256i belowY =
+                _mm256_cmpgt_epi32(tileY, _mm256_srai_epi32(interceptY, 8));
+            const __m256i belowX =
+                _mm256_cmpgt_epi32(tileX, _mm256_srai_epi32(interceptX, 8));
+            __m256i loopX = _mm256_or_si256(_mm256_and_si256(upY, belowY),
+                                            _mm256_andnot_si256(belowY, downY));
+            loopX = _mm256_or_si256(_mm256_andnot_si256(alongY, loopX), alongX);
+            __m256i loopY = _mm256_or_si256(_mm256_and_si256(upX, belowX),
+                                            _mm256_andnot_si256(belowX, downX));
+            loopY = _mm256_or_si256(_mm256_andnot_si256(alongX, loopY), alongY);
+
+            // a lane moves on to the other inner loop once its own fails
+            inLoopY = _mm256_blendv_epi8(_mm256_xor_si256(loopX, ones), loopY,
+                                         inLoopY);
+            const __m256i doX =
+                _mm256_and_si256(active, _mm256_andnot_si256(inLoopY, loopX));
+            const __m256i doY =
+                _mm256_and_si256(active, _mm256_and_si256(inLoopY, loopY));
+
+            // lanes inside an empty block take every step their loop allows
+            // up to the edge of the block, or a single one, reading no cell
+            __m256i skipX = zero;
+            __m256i skipY = zero;
+            __m256i runX = zero;
+            __m256i runY = zero;
+            __m256i stepsX = one;
+            __m256i stepsY = one;
+            __m256i lastInterceptX = interceptX;
+            __m256i lastInterceptY = interceptY;
+            if (!_mm256_testz_si256(emptyBlock, _mm256_or_si256(doX, doY))) {
+                const __m256i aheadX = _mm256_and_si256(
+                    _mm256_xor_si256(tileX, flipX), blockMask);
+                const __m256i aheadY = _mm256_and_si256(
+                    _mm256_xor_si256(tileY, flipY), blockMask);
+                skipX = _mm256_andnot_si256(_mm256_cmpeq_epi32(aheadX, zero),
+                                            _mm256_and_si256(doX, emptyBlock));
+                skipY = _mm256_andnot_si256(_mm256_cmpeq_epi32(aheadY, zero),
+                                            _mm256_and_si256(doY, emptyBlock));
+                lastInterceptY = _mm256_add_epi32(
+                    interceptY,
+                    _mm256_mullo_epi32(_mm256_sub_epi32(aheadX, one), stepY));
+                lastInterceptX = _mm256_add_epi32(
+                    interceptX,
+                    _mm256_mullo_epi32(_mm256_sub_epi32(aheadY, one), stepX));
+                const __m256i lastBelowY = _mm256_cmpgt_epi32(
+                    tileY, _mm256_srai_epi32(lastInterceptY, 8));
+                const __m256i lastBelowX = _mm256_cmpgt_epi32(
+                    tileX, _mm256_srai_epi32(lastInterceptX, 8));
+                runX = _mm256_or_si256(_mm256_and_si256(upY, lastBelowY),
+                                       _mm256_andnot_si256(lastBelowY, downY));
+                runX = _mm256_and_si256(
+                    skipX, _mm256_or_si256(_mm256_andnot_si256(alongY, runX),
+                                           alongX));
+                runY = _mm256_or_si256(_mm256_and_si256(upX, lastBelowX),
+                                       _mm256_andnot_si256(lastBelowX, downX));
+                runY = _mm256_and_si256(
+                    skipY, _mm256_or_si256(_mm256_andnot_si256(alongX, runY),
+                                           alongY));
+                stepsX = _mm256_blendv_epi8(one, aheadX, runX);
+                stepsY = _mm256_blendv_epi8(one, aheadY, runY);
+            }
+            const __m256i moved =
+                _mm256_or_si256(_mm256_andnot_si256(skipX, doX),
+                                _mm256_andnot_si256(skipY, doY));
+
+            tileX = _mm256_add_epi32(
+                tileX,
+                _mm256_and_si256(doX, _mm256_sign_epi32(stepsX, tileStepX)));
+            tileY = _mm256_add_epi32(
+                tileY,
+                _mm256_and_si256(doY, _mm256_sign_epi32(stepsY, tileStepY)));
+
+            const __m256i outside = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpgt_epi32(tileX, lastX),
+                                _mm256_cmpgt_epi32(zero, tileX)),
+                _mm256_or_si256(_mm256_cmpgt_epi32(tileY, lastY),
+                                _mm256_cmpgt_epi32(zero, tileY)));
+
+            // a step out of a block has all of the next one ahead of it
+            if (blockWalk) {
+                const __m256i leftX = _mm256_cmpeq_epi32(
+                    _mm256_and_si256(_mm256_xor_si256(tileX, flipX),
+                                     blockMask),
+                    blockMask);
+                const __m256i leftY = _mm256_cmpeq_epi32(
+                    _mm256_and_si256(_mm256_xor_si256(tileY, flipY),
+                                     blockMask),
+                    blockMask);
+                const __m256i entered = _mm256_andnot_si256(
+                    outside,
+                    _mm256_and_si256(
+                        moved,
+                        _mm256_or_si256(_mm256_and_si256(doX, leftX),
+                                        _mm256_and_si256(doY, leftY))));
+                if (!_mm256_testz_si256(entered, entered)) {
+                    const __m256i block = _mm256_add_epi32(
+                        _mm256_mullo_epi32(
+                            _mm256_srai_epi32(tileY, MAP_BLOCK_BITS), blocksX),
+                        _mm256_srai_epi32(tileX, MAP_BLOCK_BITS));
+                    const __m256i blockEmpty = _mm256_cmpeq_epi32(
+                        GatherBytes(blocks, block, entered), zero);
+                    emptyBlock =
+                        _mm256_blendv_epi8(emptyBlock, blockEmpty, entered);
+                }
+            }
+
+            // IsWall, reading cells of occupied blocks only
+            const __m256i index =
+                _mm256_add_epi32(_mm256_mullo_epi32(tileY, width), tileX);
+            const __m256i cell = _mm256_blendv_epi8(
+                GatherBytes(cells, index,
+                            _mm256_andnot_si256(
+                                _mm256_or_si256(outside, emptyBlock), moved)),
+                border, outside);
+            const __m256i wall =
+                _mm256_andnot_si256(_mm256_cmpeq_epi32(cell, zero), moved);
+            hitCell = _mm256_blendv_epi8(hitCell, cell, wall);
+
+            // a run to the edge of a block ends at its last intercept
+            vertical = _mm256_or_si256(vertical, _mm256_and_si256(wall, doX));
+            active = _mm256_andnot_si256(wall, active);
+            interceptY = _mm256_add_epi32(
+                _mm256_blendv_epi8(interceptY, lastInterceptY, runX),
+                _mm256_and_si256(_mm256_andnot_si256(wall, doX), stepY));
+            interceptX = _mm256_add_epi32(
+                _mm256_blendv_epi8(interceptX, lastInterceptX, runY),
+                _mm256_and_si256(_mm256_andnot_si256(wall, doY), stepX));
+        }
+
+        _mm256_store_si256((__m256i *) lane[0], tileX);
+        _mm256_store_si256((__m256i *) lane[1], tileY);
+        _mm256_store_si256((__m256i *) lane[2], interceptX);
+        _mm256_store_si256((__m256i *) lane[3], interceptY);
+        _mm256_store_si256((__m256i *) lane[4], vertical);
+        _mm256_store_si256((__m256i *) lane[5], hitCell);
+        for (int i = 0; i < lanes; i++) {
+            RayState &ray = rays[i];
+            ray.tileX = lane[0][i];
+            ray.tileY = lane[1][i];
+            ray.interceptX = lane[2][i];
+            ray.interceptY = lane[3][i];
+            FinishRay(rayX, rayY, ray, lane[4][i] != 0, lane[5][i],
+                      &deltaX[base + i], &deltaY[base + i],
+                      &textureNo[base + i], &textureX[base + i]);
+        }
+    }
+}
+
+// _mm512_undefined_epi32() in the AVX-512 intrinsics trips this warning
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f"))) static inline __m512i GatherBytes(
+    const int *words,
+    __m512i index,
+    __mmask16 mask)
+{
+    const __m512i word = _mm512_mask_i32gather_epi32(
+        _mm512_setzero_si512(), mask, _mm512_srli_epi32(index, 2), words, 4);
+    const __m512i shift = _mm512_slli_epi32(
+        _mm512_and_si512(index, _mm512_set1_epi32(3)), 3);
+    return _mm512_and_si512(_mm512_srlv_epi32(word, shift),
+                            _mm512_set1_epi32(0xFF));
+}
+
+__attribute__((target("avx512f"))) void
+RayCasterFixed::CalculateDistancesAVX512(const Map &map,
+                                         uint32_t rayX,
+                                         uint32_t rayY,
+                                         const uint16_t *rayA,
+                                         int count,
+                                         int32_t *deltaX,
+                                         int32_t *deltaY,
+                                         uint8_t *textureNo,
+                                         uint8_t *textureX)
+{
+    const int *cells = reinterpret_cast<const int *>(map.Cells());
+    const int *blocks = reinterpret_cast<const int *>(map.Blocks());
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i blockMask = _mm512_set1_epi32(MAP_BLOCK_SIZE - 1);
+    const __m512i width = _mm512_set1_epi32(map.Width());
+    const __m512i blocksX = _mm512_set1_epi32(map.BlocksX());
+    const __m512i border = _mm512_set1_epi32(MAP_BORDER_CELL);
+    const __m512i lastX = _mm512_set1_epi32(map.Width() - 1);
+    const __m512i lastY = _mm512_set1_epi32(map.Height() - 1);
+    const bool blockWalk = UseBlockWalk(map);
+
+    for (int base = 0; base < count; base += 16) {
+        const int lanes = count - base < 16 ? count - base : 16;
+        RayState rays[16];
+        alignas(64) int32_t lane[8][16];
+        __mmask16 emptyBlock = 0;
+
+        for (int i = 0; i < lanes; i++) {
+            RayState &ray = rays[i];
+            SetupRay(rayX, rayY, rayA[base + i], &ray);
+            emptyBlock |= (blockWalk && InEmptyBlock(map, ray)) << i;
+            lane[0][i] = ray.tileX;
+            lane[1][i] = ray.tileY;
+            lane[2][i] = ray.interceptX;
+            lane[3][i] = ray.interceptY;
+            lane[4][i] = ray.stepX;
+            lane[5][i] = ray.stepY;
+            lane[6][i] = ray.tileStepX;
+            lane[7][i] = ray.tileStepY;
+        }
+        for (int i = lanes; i < 16; i++) {
+            for (int j = 0; j < 8; j++) {
+                lane[j][i] = 0;
+            }
+        }
+        __m512i tileX = _mm512_load_si512(lane[0]);
+        __m512i tileY = _mm512_load_si512(lane[1]);
+        __m512i interceptX = _mm512_load_si512(lane[2]);
+        __m512i interceptY = _mm512_load_si512(lane[3]);
+        const __m512i stepX = _mm512_load_si512(lane[4]);
+        const __m512i stepY = _mm512_load_si512(lane[5]);
+        const __m512i tileStepX = _mm512_load_si512(lane[6]);
+        const __m512i tileStepY = _mm512_load_si512(lane[7]);
+
+        // rays along an axis only ever step along that axis
+        const __mmask16 alongX = _mm512_cmpeq_epi32_mask(tileStepY, zero);
+        const __mmask16 alongY = _mm512_cmpeq_epi32_mask(tileStepX, zero);
+        const __mmask16 upX = _mm512_cmpeq_epi32_mask(tileStepX, one);
+        const __mmask16 downX =
+            _mm512_cmpeq_epi32_mask(tileStepX, _mm512_set1_epi32(-1));
+        const __mmask16 upY = _mm512_cmpeq_epi32_mask(tileStepY, one);
+        const __mmask16 downY =
+            _mm512_cmpeq_epi32_mask(tileStepY, _mm512_set1_epi32(-1));
+        // cells ahead in a block are the low tile bits, flipped going up
+        const __m512i flipX = _mm512_maskz_mov_epi32(upX, blockMask);
+        const __m512i flipY = _mm512_maskz_mov_epi32(upY, blockMask);
+
+        __mmask16 active = static_cast<__mmask16>((1u << lanes) - 1);
+        __mmask16 inLoopY = 0;
+        __mmask16 vertical = 0;
+        __m512i hitCell = zero;
+        while (active) {
+            const __mmask16 belowY = _mm512_cmpgt_epi32_mask(
+                tileY, _mm512_srai_epi32(interceptY, 8));
+            const __mmask16 belowX = _mm512_cmpgt_epi32_mask(
+                tileX, _mm512_srai_epi32(interceptX, 8));
+            const __mmask16 loopX =
+                (((upY & belowY) | (downY & ~belowY)) & ~alongY) | alongX;
+            const __mmask16 loopY =
+                (((upX & belowX) | (downX & ~belowX)) & ~alongX) | alongY;
+
+            // a lane moves on to the other inner loop once its own fails
+            inLoopY = (inLoopY & loopY) | (~inLoopY & ~loopX);
+            const __mmask16 doX = active & ~inLoopY & loopX;
+            const __mmask16 doY = active & inLoopY & loopY;
+
+            // lanes inside an empty block take every step their loop allows
+            // up to the edge of the block, or a single one, reading no cell
+            __mmask16 skipX = 0;
+            __mmask16 skipY = 0;
+            __mmask16 runX = 0;
+            __mmask16 runY = 0;
+            __m512i stepsX = one;
+            __m512i stepsY = one;
+            __m512i lastInterceptX = interceptX;
+            __m512i lastInterceptY = interceptY;
+            if (emptyBlock & (doX | doY)) {
+                const __m512i aheadX = _mm512_and_si512(
+                    _mm512_xor_si512(tileX, flipX), blockMask);
+                const __m512i aheadY = _mm512_and_si512(
+                    _mm512_xor_si512(tileY, flipY), blockMask);
+                skipX = doX & emptyBlock &
+                        _mm512_test_epi32_mask(aheadX, aheadX);
+                skipY = doY & emptyBlock &
+                        _mm512_test_epi32_mask(aheadY, aheadY);
+                lastInterceptY = _mm512_add_epi32(
+                    interceptY,
+                    _mm512_mullo_epi32(_mm512_sub_epi32(aheadX, one), stepY));
+                lastInterceptX = _mm512_add_epi32(
+                    interceptX,
+                    _mm512_mullo_epi32(_mm512_sub_epi32(aheadY, one), stepX));
+                const __mmask16 lastBelowY = _mm512_cmpgt_epi32_mask(
+                    tileY, _mm512_srai_epi32(lastInterceptY, 8));
+                const __mmask16 lastBelowX = _mm512_cmpgt_epi32_mask(
+                    tileX, _mm512_srai_epi32(lastInterceptX, 8));
+                runX = skipX &
+                       ((((upY & lastBelowY) | (downY & ~lastBelowY)) &
+                         ~alongY) |
+                        alongX);
+                runY = skipY &
+                       ((((upX & lastBelowX) | (downX & ~lastBelowX)) &
+                         ~alongX) |
+                        alongY);
+                stepsX = _mm512_mask_mov_epi32(one, runX, aheadX);
+                stepsY = _mm512_mask_mov_epi32(one, runY, aheadY);
+            }
+            const __mmask16 moved = (doX & ~skipX) | (doY & ~skipY);
+
+            tileX = _mm512_mask_add_epi32(tileX, doX & upX, tileX, stepsX);
+            tileX = _mm512_mask_sub_epi32(tileX, doX & downX, tileX, stepsX);
+            tileY = _mm512_mask_add_epi32(tileY, doY & upY, tileY, stepsY);
+            tileY = _mm512_mask_sub_epi32(tileY, doY & downY, tileY, stepsY);
+
+            // negative tiles are above the last one unsigned
+            const __mmask16 outside = _mm512_cmpgt_epu32_mask(tileX, lastX) |
+                                      _mm512_cmpgt_epu32_mask(tileY, lastY);
+
+            // a step out of a block has all of the next one ahead of it
+            if (blockWalk) {
+                const __mmask16 entered =
+                    moved & ~outside &
+                    ((doX & _mm512_cmpeq_epi32_mask(
+                                _mm512_and_si512(_mm512_xor_si512(tileX, flipX),
+                                                 blockMask),
+                                blockMask)) |
+                     (doY & _mm512_cmpeq_epi32_mask(
+                                _mm512_and_si512(_mm512_xor_si512(tileY, flipY),
+                                                 blockMask),
+                                blockMask)));
+                if (entered) {
+                    const __m512i block = _mm512_add_epi32(
+                        _mm512_mullo_epi32(
+                            _mm512_srai_epi32(tileY, MAP_BLOCK_BITS), blocksX),
+                        _mm512_srai_epi32(tileX, MAP_BLOCK_BITS));
+                    const __mmask16 blockEmpty = _mm512_testn_epi32_mask(
+                        GatherBytes(blocks, block, entered),
+                        _mm512_set1_epi32(0xFF));
+                    emptyBlock =
+                        (emptyBlock & ~entered) | (entered & blockEmpty);
+                }
+            }
+
+            // IsWall, reading cells of occupied blocks only
+            const __m512i index =
+                _mm512_add_epi32(_mm512_mullo_epi32(tileY, width), tileX);
+            const __m512i cell = _mm512_mask_mov_epi32(
+                GatherBytes(cells, index, moved & ~outside & ~emptyBlock),
+                outside, border);
+            const __mmask16 wall = moved & _mm512_test_epi32_mask(cell, cell);
+            hitCell = _mm512_mask_mov_epi32(hitCell, wall, cell);
+
+            // a run to the edge of a block ends at its last intercept
+            vertical |= wall & doX;
+            active &= ~wall;
+            interceptY = _mm512_mask_add_epi32(
+                interceptY, doX & ~wall,
+                _mm512_mask_mov_epi32(interceptY, runX, lastInterceptY),
+                stepY);
+            interceptX = _mm512_mask_add_epi32(
+                interceptX, doY & ~wall,
+                _mm512_mask_mov_epi32(interceptX, runY, lastInterceptX),
+                stepX);
+        }
+
+        _mm512_store_si512(lane[0], tileX);
+        _mm512_store_si512(lane[1], tileY);
+        _mm512_store_si512(lane[2], interceptX);
+        _mm512_store_si512(lane[3], interceptY);
+        _mm512_store_si512(lane[4], hitCell);
+        for (int i = 0; i < lanes; i++) {
+            RayState &ray = rays[i];
+            ray.tileX = lane[0][i];
+            ray.tileY = lane[1][i];
+            ray.interceptX = lane[2][i];
+            ray.interceptY = lane[3][i];
+            FinishRay(rayX, rayY, ray, (vertical >> i) & 1, lane[4][i],
+                      &deltaX[base + i], &deltaY[base + i],
+                      &textureNo[base + i], &textureX[base + i]);
+        }
+    }
+}
+
+#pragma GCC diagnostic pop
+
+#endif  // RAYCASTER_SIMD
+
+typedef void (*DistancesKernel)(const Map &map,
+                                uint32_t rayX,
+                                uint32_t rayY,
+                                const uint16_t *rayA,
+                                int count,
+                                int32_t *deltaX,
+                                int32_t *deltaY,
+                                uint8_t *textureNo,
+                                uint8_t *textureX);
+
+void RayCasterFixed::CalculateDistances(const Map &map,
+                                        uint32_t rayX,
+                                        uint32_t rayY,
+                                        const uint16_t *rayA,
+                                        int count,
+                                        int32_t *deltaX,
+                                        int32_t *deltaY,
+                                        uint8_t *textureNo,
+                                        uint8_t *textureX)
+{
+    static const DistancesKernel kernel = [] {
+#ifdef RAYCASTER_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return &RayCasterFixed::CalculateDistancesAVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return &RayCasterFixed::CalculateDistancesAVX2;
+        }
+#endif
+        return &RayCasterFixed::CalculateDistancesScalar;
+    }();
+    kernel(map, rayX, rayY, rayA, count, deltaX, deltaY, textureNo, textureX);
+}
@@ -3,32 +3,16 @@
 #include "raycaster_float.h"
 #include <math.h>
 
-uint8_t RayCasterFloat::IsWall(float rayX, float rayY)
+uint8_t RayCasterFloat::IsWall(float rayX, float rayY) const
 {
-    float mapX = 0;
-    float mapY = 0;
-    float offsetX = modff(rayX, &mapX);
-    float offsetY = modff(rayY, &mapY);
-    int tileX = static_cast<int>(mapX);
-    int tileY = static_cast<int>(mapY);
-
-    if (tileX < 0 || tileY < 0 || tileX >= MAP_X - 1 || tileY >= MAP_Y - 1) {
-        return true;
-    }
-
-    return (g_map32[(tileX / OBSTACLES_PER_ELEMENT) +
-                    (tileY * ELEMENTS_PER_ROW)] >>
-            ((OBSTACLES_PER_ELEMENT - tileX % OBSTACLES_PER_ELEMENT) *
-             OBSTACLE_SIZE)) &
-           OBSTACLE_MASK;
+    // the cell is read in place from the map
+    return _map->Cell(static_cast<int>(rayX), static_cast<int>(rayY));
 }
 
-float RayCasterFloat::Distance(float playerX,      // In, Player location X
-                               float playerY,      // In, Player location Y
-                               float rayA,         // In, Player location Angle
-                               float *hitOffset,   // Out,
-                               int *hitDirection,  // Out,
-                               bool keepGoing)     // In
+void RayCasterFloat::StartRay(float playerX,  // In, Player location X
+                              float playerY,  // In, Player location Y
+                              float rayA,     // In, Ray angle
+                              Ray *ray) const
 {
     // Player location angle normalizarion
     while (rayA < 0) {
@@ -40,77 +24,77 @@ float RayCasterFloat::Distance(float playerX,      // In, Player location X
 
     // Split the player location into fractional part(offset) and
     // integer part(tile).
+    ray->x = playerX;
+    ray->y = playerY;
+    float offsetX = modff(ray->x, &ray->tileX);
+    float offsetY = modff(ray->y, &ray->tileY);
+
+    float vecX = 1 - offsetY;  // The case that 3pi/2 ~ pi/2
+    float vecY = 1 - offsetX;  // The case that 0 ~ pi
+    ray->tileStepX = 1;        // The case that 0 ~ pi
+    ray->tileStepY = 1;        // The case that 3pi/2 ~ pi/2
+
+    // Generate directional unit vector according to player angle
+    if (rayA > M_PI) {
+        ray->tileStepX = -1;
+        vecY = (offsetX == 0) ? 1 : offsetX;
+    }
+    if (rayA > M_PI_2 && rayA < 3 * M_PI_2) {
+        ray->tileStepY = -1;
+        vecX = (offsetY == 0) ? 1 : offsetY;
+    }
 
-    static float rayX = playerX;
-    static float rayY = playerY;
-    static float tileX = 0, tileY = 0, offsetX = 0, offsetY = 0,
-                 startDeltaX = 0, startDeltaY = 0, interceptX = 0,
-                 interceptY = 0;
-    static int tileStepX = 0, tileStepY = 0;
-    if (!keepGoing) {
-        rayX = playerX;
-        rayY = playerY;
-        offsetX = modff(rayX, &tileX);
-        offsetY = modff(rayY, &tileY);
-
-        float vecX = 1 - offsetY;  // The case that 3pi/2 ~ pi/2
-        float vecY = 1 - offsetX;  // The case that 0 ~ pi
-        tileStepX = 1;             // The case that 0 ~ pi
-        tileStepY = 1;             // The case that 3pi/2 ~ pi/2
-
-        // Generate directional unit vector according to player angle
-        if (rayA > M_PI) {
-            tileStepX = -1;
-            vecY = (offsetX == 0) ? 1 : offsetX;
-        }
-        if (rayA > M_PI_2 && rayA < 3 * M_PI_2) {
-            tileStepY = -1;
-            vecX = (offsetY == 0) ? 1 : offsetY;
-        }
+    // Calculate the starting delta
+    float startDeltaX = vecX * tan(rayA) * ray->tileStepY;
+    float startDeltaY = vecY / tan(rayA) * ray->tileStepX;
 
-        // Calculate the starting delta
-        startDeltaX = vecX * tan(rayA) * tileStepY;
-        startDeltaY = vecY / tan(rayA) * tileStepX;
+    ray->interceptX = ray->x + startDeltaX;
+    ray->interceptY = ray->y + startDeltaY;
+    ray->stepX = fabs(tan(rayA)) * ray->tileStepX;
+    ray->stepY = fabs(1 / tan(rayA)) * ray->tileStepY;
+}
 
-        interceptX = rayX + startDeltaX;
-        interceptY = rayY + startDeltaY;
-    }
-    float stepX = fabs(tan(rayA)) * tileStepX;
-    float stepY = fabs(1 / tan(rayA)) * tileStepY;
+float RayCasterFloat::Distance(float playerX,      // In, Player location X
+                               float playerY,      // In, Player location Y
+                               Ray *ray,           // In/Out, traversal
+                               float *hitOffset,   // Out,
+                               int *hitDirection)  // Out,
+    const
+{
     bool verticalHit = false;
     bool horizontalHit = false;
     bool somethingDone = false;
 
     do {
         somethingDone = false;
-        while (((tileStepY == 1 && (interceptY <= tileY + 1)) ||
-                (tileStepY == -1 && (interceptY >= tileY)))) {
+        while (((ray->tileStepY == 1 && (ray->interceptY <= ray->tileY + 1)) ||
+                (ray->tileStepY == -1 && (ray->interceptY >= ray->tileY)))) {
             somethingDone = true;
-            tileX += tileStepX;
-            if (*hitDirection = IsWall(tileX, interceptY)) {
+            ray->tileX += ray->tileStepX;
+            if (*hitDirection = IsWall(ray->tileX, ray->interceptY)) {
                 verticalHit = true;
-                rayX = tileX + (tileStepX == -1 ? 1 : 0);
-                rayY = interceptY;
-                *hitOffset = interceptY;
-                // Use odd number to indicate different hit direction
-                *hitDirection = (*hitDirection - 1) * 2 + 1;
+                ray->x = ray->tileX + (ray->tileStepX == -1 ? 1 : 0);
+                ray->y = ray->interceptY;
+                *hitOffset = ray->interceptY;
+                *hitDirection = Map::FaceTexture(*hitDirection, true);
                 break;
             }
-            interceptY += stepY;
+            ray->interceptY += ray->stepY;
         }
-        while (!verticalHit && ((tileStepX == 1 && (interceptX <= tileX + 1)) ||
-                                (tileStepX == -1 && (interceptX >= tileX)))) {
+        while (!verticalHit &&
+               ((ray->tileStepX == 1 && (ray->interceptX <= ray->tileX + 1)) ||
+                (ray->tileStepX == -1 && (ray->interceptX >= ray->tileX)))) {
             somethingDone = true;
-            tileY += tileStepY;
-            if (*hitDirection = IsWall(interceptX, tileY)) {
+            ray->tileY += ray->tileStepY;
+            if (*hitDirection = IsWall(ray->interceptX, ray->tileY)) {
                 horizontalHit = true;
-                rayX = interceptX;
-                *hitOffset = interceptX;
-                rayY = tileY + (tileStepY == -1 ? 1 : 0);
-                *hitDirection = (*hitDirection - 1) * 2;
+                ray->x = ray->interceptX;
+                *hitOffset = ray->interceptX;
+                ray->y = ray->tileY + (ray->tileStepY == -1 ? 1 : 0);
+                *hitDirection = Map::FaceTexture(*hitDirection, false);
                 break;
             }
-            interceptX += stepX;
+            ray->interceptX += ray->stepX;
         }
     } while ((!horizontalHit && !verticalHit) && somethingDone);
 
@@ -118,35 +102,30 @@ float RayCasterFloat::Distance(float playerX,      // In, Player location X
         return 0;
     }
 
-    float deltaX = rayX - playerX;
-    float deltaY = rayY - playerY;
+    float deltaX = ray->x - playerX;
+    float deltaY = ray->y - playerY;
+    // the next call goes on from the cell behind the hit
     if (verticalHit)
-        interceptY += stepY;
+        ray->interceptY += ray->stepY;
     else
-        interceptX += stepX;
+        ray->interceptX += ray->stepX;
 
     return sqrt(deltaX * deltaX + deltaY * deltaY);
 }
 
-void RayCasterFloat::Trace(uint16_t screenX,
-                           uint8_t *screenY,
-                           uint8_t *textureNo,
-                           uint8_t *textureX,
-                           uint16_t *textureY,
-                           uint16_t *textureStep)
+float RayCasterFloat::TraceColumn(uint16_t screenX,
+                                  Ray *ray,
+                                  uint16_t *screenY,
+                                  uint8_t *textureNo,
+                                  uint8_t *textureX,
+                                  uint16_t *textureY,
+                                  uint16_t *textureStep) const
 {
-    static uint16_t previousX = UINT16_MAX;
-    bool keepGoing = false;
-    if (screenX == previousX)
-        keepGoing = true;
-    previousX = screenX;
-
     float hitOffset;
     int hitDirection;
-    float deltaAngle = atanf(((int16_t) screenX - SCREEN_WIDTH / 2.0f) /
-                             (SCREEN_WIDTH / (2.0f * tanf(FOV_X / 2.0f))));
-    float lineDistance = Distance(_playerX, _playerY, _playerA + deltaAngle,
-                                  &hitOffset, &hitDirection, keepGoing);
+    float deltaAngle = _deltaAngle[screenX];
+    float lineDistance =
+        Distance(_playerX, _playerY, ray, &hitOffset, &hitDirection);
     float distance = lineDistance * cos(deltaAngle);
     float dum;
     *textureX = (uint8_t)(256.0f * modff(hitOffset, &dum));
@@ -154,25 +133,97 @@ void RayCasterFloat::Trace(uint16_t screenX,
     *textureY = 0;
     *textureStep = 0;
     if (distance > 0) {
-        auto txs = 2.0f * INV_FACTOR / distance;
-        if (txs > SCREEN_HEIGHT) {
-            *screenY = SCREEN_HEIGHT / 2;
+        auto txs = 2.0f * _invFactor / distance;
+        const float step = TEXTURE_SIZE * (1 << 10) / txs;
+        *textureStep = step < UINT16_MAX ? static_cast<uint16_t>(step)
+                                         : UINT16_MAX;
+        if (txs > _height) {
+            *screenY = _height / 2;
             *textureY = static_cast<uint16_t>(
-                TEXTURE_SIZE * (txs - SCREEN_HEIGHT) / 2 / txs * (1 << 10));
+                TEXTURE_SIZE * (txs - _height) / 2 / txs * (1 << 10));
         } else
             *screenY = txs / 2;
     } else {
         *screenY = 0;
     }
+    return distance;
+}
+
+void RayCasterFloat::Trace(uint16_t screenX,
+                           uint16_t *screenY,
+                           uint8_t *textureNo,
+                           uint8_t *textureX,
+                           uint16_t *textureY,
+                           uint16_t *textureStep)
+{
+    Ray ray;
+    StartRay(_playerX, _playerY, _playerA + _deltaAngle[screenX], &ray);
+    TraceColumn(screenX, &ray, screenY, textureNo, textureX, textureY,
+                textureStep);
+}
+
+int RayCasterFloat::TraceWalls(uint16_t screenX, WallHit *hits, int maxHits)
+{
+    // the ray goes on from each wall to the next one
+    Ray ray;
+    StartRay(_playerX, _playerY, _playerA + _deltaAngle[screenX], &ray);
+    int found = 0;
+    while (found < maxHits) {
+        // a ray that does not move hits nothing, its texture is undefined
+        WallHit hit;
+        const float distance =
+            TraceColumn(screenX, &ray, &hit.screenY, &hit.textureNo,
+                        &hit.textureX, &hit.textureY, &hit.textureStep);
+        if (distance <= 0) {
+            break;
+        }
+        hit.depth = static_cast<uint32_t>(distance * 256.0f);
+        hits[found++] = hit;
+    }
+    return found;
+}
+
+void RayCasterFloat::TraceColumns(uint16_t first,
+                                  uint16_t count,
+                                  ColumnHit *out)
+{
+    for (uint16_t x = first; x < first + count; x++) {
+        Ray ray;
+        StartRay(_playerX, _playerY, _playerA + _deltaAngle[x], &ray);
+        const float distance =
+            TraceColumn(x, &ray, &out->screenY[x], &out->textureNo[x],
+                        &out->textureX[x], &out->textureY[x],
+                        &out->textureStep[x]);
+        out->depth[x] =
+            distance > 0 ? static_cast<uint32_t>(distance * 256.0f) : 0;
+    }
 }
 
-void RayCasterFloat::Start(uint16_t playerX, uint16_t playerY, int16_t playerA)
+void RayCasterFloat::Start(uint32_t playerX, uint32_t playerY, int16_t playerA)
 {
     _playerX = (playerX / 1024.0f) * 4.0f;
     _playerY = (playerY / 1024.0f) * 4.0f;
     _playerA = (playerA / 1024.0f) * 2.0f * M_PI;
 }
 
-RayCasterFloat::RayCasterFloat() : RayCaster() {}
+RayCaster *RayCasterFloat::Clone() const
+{
+    return new RayCasterFloat(*this);
+}
+
+RayCasterFloat::RayCasterFloat(uint16_t width,
+                               uint16_t height,
+                               double fov,
+                               const Map &map)
+    : RayCaster(width, height, map),
+      _deltaAngle(width),
+      _invFactor(WALL_HEIGHT * width / (4.0f * tanf(fov / 2))),
+      _tanHalf(tanf(fov / 2))
+{
+    for (uint16_t x = 0; x < width; x++) {
+        _deltaAngle[x] = atanf(((int16_t) x - width / 2.0f) /
+                               (width / (2.0f * tanf(fov / 2.0f))));
+    }
+}
 
 RayCasterFloat::~RayCasterFloat() {}
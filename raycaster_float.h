@@ -1,31 +1,66 @@
 #pragma once
+#include <vector>
 #include "raycaster.h"
-#include "raycaster_data.h"
 
 class RayCasterFloat : public RayCaster
 {
 public:
-    void Start(uint16_t playerX, uint16_t playerY, int16_t playerA);
+    void Start(uint32_t playerX, uint32_t playerY, int16_t playerA);
     void Trace(uint16_t screenX,
-               uint8_t *screenY,
+               uint16_t *screenY,
                uint8_t *textureNo,
                uint8_t *textureX,
                uint16_t *textureY,
                uint16_t *textureStep);
+    int TraceWalls(uint16_t screenX, WallHit *hits, int maxHits);
+    void TraceColumns(uint16_t first, uint16_t count, ColumnHit *out);
+    float WallScale() const { return _invFactor; }
+    float TanHalfFov() const { return _tanHalf; }
+    RayCaster *Clone() const;
 
-    RayCasterFloat();
+    RayCasterFloat(uint16_t width = SCREEN_WIDTH,
+                   uint16_t height = SCREEN_HEIGHT,
+                   double fov = FOV_X,
+                   const Map &map = Map::Default());
     ~RayCasterFloat();
 
 private:
+    // angle of every screen column relative to the view direction
+    std::vector<float> _deltaAngle;
+    float _invFactor;
+    float _tanHalf;
     float _playerX;
     float _playerY;
     float _playerA;
 
+    // Traversal state of a ray, kept between Distance calls so that a ray
+    // can go on behind the wall it hit
+    struct Ray {
+        float x;  // last hit, or the player before the first one
+        float y;
+        float tileX;
+        float tileY;
+        float interceptX;
+        float interceptY;
+        float stepX;
+        float stepY;
+        int tileStepX;
+        int tileStepY;
+    };
+    void StartRay(float playerX, float playerY, float rayA, Ray *ray) const;
+    // Advance ray to its next wall and return the distance to it
     float Distance(float playerX,
                    float playerY,
-                   float rayA,
+                   Ray *ray,
                    float *hitOffset,
-                   int *hitDirection,
-                   bool keepGoint = false);
-    uint8_t IsWall(float rayX, float rayY);
+                   int *hitDirection) const;
+    uint8_t IsWall(float rayX, float rayY) const;
+    // returns the perpendicular distance of the wall
+    float TraceColumn(uint16_t screenX,
+                      Ray *ray,
+                      uint16_t *screenY,
+                      uint8_t *textureNo,
+                      uint8_t *textureX,
+                      uint16_t *textureY,
+                      uint16_t *textureStep) const;
 };
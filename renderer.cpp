@@ -1,91 +1,506 @@
 #include "renderer.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include "raycaster_data.h"
 
 uint16_t Renderer::RecursiveTraceFrame(
+    RayCaster *rc,   // In, caster of the calling thread
     uint32_t *fb,    // In, Frame buffer
     int x,           // In, screen X
     uint16_t up,     // In, upper screen position
     uint16_t down,   // In, lower screen position
     uint8_t offset)  // In, downscale
 {
-    uint8_t sso;   // top point of wall
-    uint8_t tc;    // x axis of texture (256 -> 64)
-    uint8_t tn;    // texture number
-    uint16_t tso;  // y axis of texture
-    uint16_t tst;  // texture step (currentlt not used)
-    uint32_t *lb = fb + x + up * SCREEN_WIDTH;  // frame buffer
+    return TraceColumn(rc, fb + x, _width, x, up, down, offset);
+}
 
-    _rc->Trace(x, &sso, &tn, &tc, &tso, &tst);
+uint16_t Renderer::TraceColumn(RayCaster *rc,
+                               uint32_t *lb,
+                               int stride,
+                               int x,
+                               uint16_t up,
+                               uint16_t down,
+                               uint8_t offset)
+{
+    ColumnHit &hits = _views[0]->hits;
+    rc->Trace(x, &hits.screenY[x], &hits.textureNo[x], &hits.textureX[x],
+              &hits.textureY[x], &hits.textureStep[x]);
+    return RenderColumn(hits, lb, stride, x, up, down, offset);
+}
+
+uint16_t Renderer::RenderColumn(
+    const ColumnHit &hits,  // In, hit of the column
+    uint32_t *lb,        // In, top pixel of the column in the frame buffer
+    int stride,          // In, distance between the rows of the frame buffer
+    int x,               // In, screen X
+    uint16_t up,         // In, upper screen position
+    uint16_t down,       // In, lower screen position
+    uint8_t offset,      // In, downscale
+    bool texturedFloor)  // In, floor and ceiling drawn over the background
+{
+    uint16_t sso = hits.screenY[x];   // top point of wall
+    uint8_t tc = hits.textureX[x];    // x axis of texture (256 -> 64)
+    uint8_t tn = hits.textureNo[x];   // texture number
+    uint16_t tso = hits.textureY[x];  // y axis of texture
 
     auto tx = static_cast<int>(tc >> 2);
-    if (sso >= HORIZON_HEIGHT)
-        sso = HORIZON_HEIGHT;
+    if (sso >= _horizon)
+        sso = _horizon;
+    lb += up * stride;
 
-    // render top sky
-    for (int y = up; y < HORIZON_HEIGHT - sso; y++) {
-        if (offset > 0)
-            *lb = DOWN_SCALE(*lb) +
-                  DOWN_SCALE(GetARGB(96 + (HORIZON_HEIGHT - y)));
-        else
-            *lb = GetARGB(96 + (HORIZON_HEIGHT - y));
-        lb += SCREEN_WIDTH;
+    // render top sky, unless the ceiling covers it later
+    if (texturedFloor) {
+        lb += std::max(_horizon - sso - up, 0) * stride;
+    } else {
+        lb = FillBackground(lb, stride, up, _horizon - sso, offset > 0);
     }
 
     // render obstacle
-    for (int y = 0; y < sso * 2; y++) {
-        // paint texture pixel
-        uint16_t ty =
-            (tso + (((TEXTURE_SIZE / 2) << 10) - tso) * y / sso) >> 10;
-
-        uint16_t tv;
-        uint32_t color;
-        if (tn / 2 < NUMBER_OF_GRAY_TEXTURE) {
-            // gray scale texture
-            tv = (g_texture_gray[tn / 2])[(ty << 6) + tx];
-            color = GetARGB(tv);
-        } else {
-            // colored texture
-            tv = (g_texture_color[tn / 2 - 1])[(ty << 6) + tx];
-            color = GetARGB_color(tv);
+    WallSpan span;
+    span.level = _mipmaps ? MipLevelForStep(hits.textureStep[x]) : 0;
+    // every face of a cell shows the texture of the cell, which the face
+    // bit of the texture number does not change; maps may name more
+    // textures than there are
+    span.texels = _textures.Column(tn / 2 % _textures.Size(), span.level, tx);
+    // both casters start walls taller than the screen above the texture
+    // top and within its upper half
+    const uint32_t middle = (TEXTURE_SIZE / 2) << 10;
+    span.textureY = std::min<uint32_t>(tso, middle);
+    span.remainder = 0;
+    span.divisor = sso;
+    if (sso > 0) {
+        span.textureStep = (middle - span.textureY) / sso;
+        span.remainderStep = (middle - span.textureY) % sso;
+        FillWallSpan(lb, stride, sso * 2, span, offset > 0);
+    }
+    lb += sso * 2 * stride;
+
+    // render bottom sky
+    if (!texturedFloor) {
+        FillBackground(lb, stride, _horizon + sso, down, offset > 0);
+    }
+    return sso;
+}
+
+uint32_t *Renderer::FillBackground(uint32_t *lb,
+                                   int stride,
+                                   int first,
+                                   int last,
+                                   bool blend) const
+{
+    if (first >= last) {
+        return lb;
+    }
+    const uint32_t *background = &_background[first];
+    const int count = last - first;
+    if (blend) {
+        for (int y = 0; y < count; y++) {
+            *lb = DOWN_SCALE(*lb) + DOWN_SCALE(background[y]);
+            lb += stride;
+        }
+    } else if (stride == 1) {
+        memcpy(lb, background, count * sizeof(uint32_t));
+        lb += count;
+    } else {
+        for (int y = 0; y < count; y++) {
+            *lb = background[y];
+            lb += stride;
         }
+    }
+    return lb;
+}
 
-        if (offset > 0)
-            *lb = DOWN_SCALE(*lb) + DOWN_SCALE(color);
-        else
-            *lb = color;
+void Renderer::DrawColumns(RayCaster *rc,
+                           ColumnHit *hits,
+                           bool godMode,
+                           uint32_t *lb,
+                           int step,
+                           int stride,
+                           int first,
+                           int count)
+{
+    if (rc != NULL && godMode) {
+        // see-through rendering draws the wall behind the first one into it,
+        // both found by a single walk of the ray
+        for (int x = first; x < first + count; x++) {
+            uint32_t *column = lb + (x - first) * step;
+            WallHit walls[2];
+            const int found = rc->TraceWalls(x, walls, 2);
+            if (found == 0) {
+                // no wall, the column only shows the background
+                walls[0] = WallHit();
+            }
+            hits->Set(x, walls[0]);
+            const uint16_t sso =
+                RenderColumn(*hits, column, stride, x, 0, _height, 0);
+            if (found > 1) {
+                hits->Set(x, walls[1]);
+                RenderColumn(*hits, column, stride, x, _horizon - sso,
+                             _horizon + sso, 1);
+                // the hits of a frame hold the nearest wall of each column
+                hits->Set(x, walls[0]);
+            }
+        }
+        return;
+    }
 
-        lb += SCREEN_WIDTH;
+    if (rc != NULL) {
+        rc->TraceColumns(first, count, hits);
     }
+    for (int x = first; x < first + count; x++) {
+        RenderColumn(*hits, lb + (x - first) * step, stride, x, 0, _height, 0,
+                     _texturedFloor);
+    }
+}
 
-    // render bottom sky
-    for (int y = HORIZON_HEIGHT + sso; y < down; y++) {
-        if (offset > 0)
-            *lb =
-                DOWN_SCALE(*lb) + DOWN_SCALE(GetARGB(96 + y - HORIZON_HEIGHT));
-        else
-            *lb = GetARGB(96 + y - HORIZON_HEIGHT);
-        lb += SCREEN_WIDTH;
+void Renderer::DrawFrameColumns(RayCaster *rc,
+                                ColumnHit *hits,
+                                bool godMode,
+                                uint32_t *fb,
+                                int stride,
+                                uint32_t *strip,
+                                int first,
+                                int count)
+{
+    // see-through rendering blends into what it drew, which it reads back
+    // from the strip rather than from the frame buffer
+    if (!_columnMajor && !godMode) {
+        DrawColumns(rc, hits, godMode, fb + first, 1, stride, first, count);
+        return;
+    }
+    // a few columns at a time, transposed while they are still in cache
+    for (int x = first; x < first + count; x += STRIP_COLUMNS) {
+        const int n = first + count - x < STRIP_COLUMNS ? first + count - x
+                                                        : STRIP_COLUMNS;
+        DrawColumns(rc, hits, godMode, strip, _height, 1, x, n);
+        Transpose(strip, _height, fb + x, stride, n, _height);
     }
-    return sso;
 }
 
-void Renderer::TraceFrame(Game *g, uint32_t *fb)
+void Renderer::DrawFloor(const View &view,
+                         uint32_t *fb,
+                         int stride,
+                         int first,
+                         int count) const
 {
-    _rc->Start(static_cast<uint16_t>(g->playerX * 256.0f),
-               static_cast<uint16_t>(g->playerY * 256.0f),
-               static_cast<int16_t>(g->playerA / (2.0f * M_PI) * 1024.0f));
+    const uint16_t *screenY = view.hits.screenY.data();
+    for (int row = 0; row < view.floor.Rows(); row++) {
+        const FloorCaster::Row r = view.floor.GetRow(row);
+        // the row steps through the texture both along and across itself
+        const int level =
+            _mipmaps ? MipLevelForStep(std::max(
+                           {abs(r.stepX), abs(r.stepY), abs(r.stepRow)}))
+                     : 0;
+        const uint32_t *floor = _textures.Column(FLOOR_TEXTURE, level, 0);
+        const uint32_t *ceiling = _textures.Column(CEILING_TEXTURE, level, 0);
+        const int shift = 16 - TEXTURE_XS + level;
+        const int bits = TEXTURE_XS - level;
+        const int mask = (1 << bits) - 1;
+
+        uint32_t *floorRow = fb + (_horizon + row) * stride;
+        uint32_t *ceilingRow =
+            row < _horizon ? fb + (_horizon - 1 - row) * stride : NULL;
+        int32_t x = r.x + r.stepX * first;
+        int32_t y = r.y + r.stepY * first;
+        for (int sx = first; sx < first + count;
+             sx++, x += r.stepX, y += r.stepY) {
+            // rows the wall of the column covers
+            if (screenY[sx] > row) {
+                continue;
+            }
+            // textures are stored column by column
+            const int texel = (((x >> shift) & mask) << bits) |
+                              ((y >> shift) & mask);
+            floorRow[sx] = floor[texel];
+            if (ceilingRow != NULL) {
+                ceilingRow[sx] = ceiling[texel];
+            }
+        }
+    }
+}
+
+void Renderer::ProjectBillboards(const Game *g, View *view)
+{
+    view->billboards.clear();
+    if (g->billboards.Size() == 0) {
+        return;
+    }
+    const float x = view->playerX / 256.0f;
+    const float y = view->playerY / 256.0f;
+    const float angle = view->playerA * static_cast<float>(M_PI) / 512.0f;
+    const float dirX = sinf(angle);
+    const float dirY = cosf(angle);
+    const float tanHalf = _rc->TanHalfFov();
+    const float focal = _width / 2 / tanHalf;
+    const float wallScale = _rc->WallScale();
+
+    // nothing behind the farthest wall can be seen
+    const uint32_t farthest =
+        *std::max_element(view->hits.depth.begin(), view->hits.depth.end());
+    view->culled.clear();
+    g->billboards.Cull(x, y, dirX - dirY * tanHalf, dirY + dirX * tanHalf,
+                       dirX + dirY * tanHalf, dirY - dirX * tanHalf,
+                       farthest / 256.0f + 1, &view->culled);
 
-    for (int x = 0; x < SCREEN_WIDTH; x++) {
-        uint16_t sso = RecursiveTraceFrame(fb, x, 0, SCREEN_HEIGHT, 0);
-        if (g->godMode > 0)
-            sso = RecursiveTraceFrame(fb, x, HORIZON_HEIGHT - sso,
-                                      HORIZON_HEIGHT + sso, 1);
+    for (int id : view->culled) {
+        const Billboard &b = g->billboards.Get(id);
+        const float dx = b.x - x;
+        const float dy = b.y - y;
+        const float depth = dx * dirX + dy * dirY;
+        if (depth < 1.0f / 16 || depth * 256 >= farthest) {
+            continue;
+        }
+        // one cell wide, as tall as a wall at the same distance
+        const float size = focal / depth;
+        const float left = _width / 2 + (dx * dirY - dy * dirX) * size -
+                           size / 2;
+        BillboardSpan s;
+        s.left = std::max(static_cast<int>(ceilf(left)), 0);
+        s.right = std::min(static_cast<int>(ceilf(left + size)), _width);
+        const int sso = static_cast<int>(wallScale / depth);
+        if (s.left >= s.right || sso == 0) {
+            continue;
+        }
+        s.id = id;
+        s.depth = static_cast<uint32_t>(depth * 256);
+        s.textureXStep = static_cast<int32_t>(TEXTURE_SIZE * 65536 / size);
+        s.textureX = static_cast<int32_t>((s.left - left) * s.textureXStep);
+        s.textureStep = TEXTURE_SIZE * 1024 / (2 * sso);
+        s.top = std::max(_horizon - sso, 0);
+        s.rows = std::min(_horizon + sso, _height) - s.top;
+        s.textureY = (s.top - (_horizon - sso)) * s.textureStep;
+        s.texels = _textures.Column(b.texture % _textures.Size(), 0, 0);
+        s.masks = _textures.Masks(b.texture % _textures.Size(), 0, 0);
+        view->billboards.push_back(s);
     }
+    std::sort(view->billboards.begin(), view->billboards.end(),
+              [](const BillboardSpan &a, const BillboardSpan &b) {
+                  return a.depth != b.depth ? a.depth > b.depth : a.id < b.id;
+              });
 }
 
-void Renderer::RenderGame(Game *g, uint32_t *fb)
+void Renderer::DrawBillboards(const View &view,
+                              uint32_t *fb,
+                              int stride,
+                              int first,
+                              int count) const
 {
+    const uint32_t *depth = view.hits.depth.data();
+    for (const BillboardSpan &s : view.billboards) {
+        const int left = std::max(s.left, first);
+        const int right = std::min(s.right, first + count);
+        int32_t textureX = s.textureX + (left - s.left) * s.textureXStep;
+        for (int x = left; x < right; x++, textureX += s.textureXStep) {
+            if (s.depth >= depth[x]) {
+                continue;
+            }
+            // textures are stored column by column
+            const int column =
+                ((textureX >> 16) & (TEXTURE_SIZE - 1)) * TEXTURE_SIZE;
+            const uint32_t *texels = s.texels + column;
+            const uint32_t *masks = s.masks + column;
+            uint32_t *lb = fb + s.top * stride + x;
+            uint32_t textureY = s.textureY;
+            for (int y = 0; y < s.rows; y++) {
+                const int ty = (textureY >> 10) & (TEXTURE_SIZE - 1);
+                if (masks[ty] != 0) {
+                    *lb = texels[ty];
+                }
+                lb += stride;
+                textureY += s.textureStep;
+            }
+        }
+    }
+}
+
+void Renderer::StartViews(const Viewpoint *views, int count)
+{
+    while (static_cast<int>(_views.size()) < count) {
+        _views.emplace_back(new View(_rc));
+    }
+    for (int i = 0; i < count; i++) {
+        View *view = _views[i].get();
+        RayCaster::ToView(views[i].x, views[i].y, views[i].a, &view->playerX,
+                          &view->playerY, &view->playerA);
+        view->floor.Start(view->playerX, view->playerY, view->playerA);
+    }
+}
+
+void Renderer::RunColumns(
+    int views,
+    const std::function<void(RayCaster *, int, uint32_t *, int, int)> &job)
+{
+    const int threads = _pool->Size();
+    const int columns = _width * views;
+
+    // Every column is rendered by the same code whichever worker owns it, so
+    // the output does not depend on the number of threads.
+    _pool->Run([&](int i) {
+        RayCaster *rc = i == 0 ? _rc : _casters[i - 1].get();
+        uint32_t *strip = &_strips[i * STRIP_COLUMNS * _height];
+        const int last = columns * (i + 1) / threads;
+        for (int c = columns * i / threads; c < last;) {
+            const int v = c / _width;
+            const int first = c - v * _width;
+            const int count = std::min(last - c, _width - first);
+            const View *view = _views[v].get();
+            rc->Start(view->playerX, view->playerY, view->playerA);
+            job(rc, v, strip, first, count);
+            c += count;
+        }
+    });
+}
+
+void Renderer::TraceFrame(Game *g, uint32_t *fb, int stride)
+{
+    const Viewpoint view = {g->playerX, g->playerY, g->playerA};
+    TraceViews(g, &view, &fb, 1, stride);
+}
+
+void Renderer::TraceViews(const Game *g,
+                          const Viewpoint *views,
+                          uint32_t *const *fbs,
+                          int count,
+                          int stride)
+{
+    const bool godMode = g->godMode > 0;
+    if (stride == 0) {
+        stride = _width;
+    }
+    StartViews(views, count);
+    RunColumns(count, [&](RayCaster *rc, int v, uint32_t *strip, int first,
+                          int n) {
+        DrawFrameColumns(rc, &_views[v]->hits, godMode, fbs[v], stride,
+                         strip, first, n);
+        if (_texturedFloor && !godMode) {
+            DrawFloor(*_views[v], fbs[v], stride, first, n);
+        }
+    });
+    if (godMode) {
+        return;
+    }
+    // the billboards need the depth of every column first
+    bool billboards = false;
+    for (int v = 0; v < count; v++) {
+        ProjectBillboards(g, _views[v].get());
+        billboards = billboards || !_views[v]->billboards.empty();
+    }
+    if (billboards) {
+        RunColumns(count, [&](RayCaster *, int v, uint32_t *, int first,
+                              int n) {
+            DrawBillboards(*_views[v], fbs[v], stride, first, n);
+        });
+    }
+}
+
+void Renderer::TraceHits(Game *g)
+{
+    const Viewpoint view = {g->playerX, g->playerY, g->playerA};
+    TraceHits(&view, 1);
+}
+
+void Renderer::FillFrame(Game *g, uint32_t *fb, int stride)
+{
+    FillFrames(g, &fb, 1, stride);
+}
+
+void Renderer::TraceHits(const Viewpoint *views, int count)
+{
+    StartViews(views, count);
+    RunColumns(count, [&](RayCaster *rc, int v, uint32_t *, int first,
+                          int n) {
+        rc->TraceColumns(first, n, &_views[v]->hits);
+    });
+}
+
+void Renderer::FillFrames(const Game *g,
+                          uint32_t *const *fbs,
+                          int count,
+                          int stride)
+{
+    if (stride == 0) {
+        stride = _width;
+    }
+    for (int v = 0; v < count; v++) {
+        ProjectBillboards(g, _views[v].get());
+    }
+    RunColumns(count, [&](RayCaster *, int v, uint32_t *strip, int first,
+                          int n) {
+        const View &view = *_views[v];
+        DrawFrameColumns(NULL, &_views[v]->hits, false, fbs[v], stride, strip,
+                         first, n);
+        if (_texturedFloor) {
+            DrawFloor(view, fbs[v], stride, first, n);
+        }
+        DrawBillboards(view, fbs[v], stride, first, n);
+    });
+}
+
+void Renderer::SetColumnMajor(bool columnMajor)
+{
+    _columnMajor = columnMajor;
+    // see-through rendering uses the strips in either mode
+    _strips.assign(_pool->Size() * STRIP_COLUMNS * _height, 0);
+}
+
+void Renderer::SetThreadCount(int threads)
+{
+    if (threads < 1) {
+        threads = 1;
+    }
+    _pool.reset(new ThreadPool(threads));
+    _casters.clear();
+    for (int i = 1; i < threads; i++) {
+        _casters.emplace_back(_rc->Clone());
+    }
+    SetColumnMajor(_columnMajor);
+}
+
+Renderer::Renderer(RayCaster *rc, int threads)
+    : _rc(rc),
+      _width(rc->Width()),
+      _height(rc->Height()),
+      _horizon(rc->Height() / 2),
+      _shade((128 << 16) / _horizon),
+      _background(rc->Height()),
+      _columnMajor(false),
+      _mipmaps(true),
+      _texturedFloor(false),
+      _gunSide(g_texture_gun_side,
+               TEXTURE_GUN_SIDE_WIDTH,
+               TEXTURE_GUN_SIDE_HEIGHT),
+      _gunCenter(g_texture_gun_center,
+                 TEXTURE_GUN_CENTER_WIDTH,
+                 TEXTURE_GUN_CENTER_HEIGHT)
+{
+    // gray scale textures first, then the colored ones
+    _textures.Add(MipChain<uint8_t>(g_texture8));
+    _textures.Add(MipChain<uint16_t>(g_texture8_computer));
+    _textures.Add(MipChain<uint16_t>(g_texture8_cat));
+    for (int y = 0; y < _height; y++) {
+        _background[y] = GetBackground(y < _horizon ? _horizon - y
+                                                    : y - _horizon);
+    }
+    _views.emplace_back(new View(rc));
+    SetThreadCount(threads);
+}
+
+Renderer::View::View(const RayCaster *rc)
+    : playerX(0),
+      playerY(0),
+      playerA(0),
+      hits(rc->Width()),
+      floor(rc->Width(), rc->Height(), rc->WallScale(), rc->TanHalfFov())
+{
+}
+
+void Renderer::RenderGame(Game *g, uint32_t *fb, int stride)
+{
+    if (stride == 0) {
+        stride = _width;
+    }
     static float time = 0, offset = 0;
     if (g->moving > 0) {
         time += 0.02f;
@@ -96,45 +511,23 @@ void Renderer::RenderGame(Game *g, uint32_t *fb)
 
     // rendering hand and gun
     if (g->pose == POSE_SQUAT) {
-        const int sx = SCREEN_WIDTH / 2 - TEXTURE_GUN_CENTER_WIDTH / 2 + 1;
-        const int sy = SCREEN_HEIGHT - TEXTURE_GUN_CENTER_HEIGHT;
-        uint32_t *lb = fb + sy * SCREEN_WIDTH + sx;
-        for (int j = 0; j < TEXTURE_GUN_CENTER_HEIGHT; j++) {
-            for (int i = 0; i < TEXTURE_GUN_CENTER_WIDTH; i++) {
-                auto tv =
-                    g_texture_gun_center[j * TEXTURE_GUN_CENTER_WIDTH + i];
-
-                if ((tv & 0x8000) == 0)
-                    *lb = GetARGB_color(tv);
-                lb++;
-            }
-            lb += SCREEN_WIDTH - TEXTURE_GUN_SIDE_WIDTH;
-        }
+        const int sx = _width / 2 - _gunCenter.width / 2 + 1;
+        const int sy = _height - _gunCenter.height;
+        _gunCenter.Draw(fb + sy * stride + sx, stride, _gunCenter.height);
     } else {
-        uint32_t *lb =
-            fb +
-            (SCREEN_HEIGHT - TEXTURE_GUN_SIDE_HEIGHT + (uint8_t) offset) *
-                SCREEN_WIDTH +
-            (SCREEN_WIDTH - TEXTURE_GUN_SIDE_WIDTH);
-        for (int j = 0; j < TEXTURE_GUN_SIDE_HEIGHT - (uint8_t) offset; j++) {
-            for (int i = 0; i < TEXTURE_GUN_SIDE_WIDTH; i++) {
-                auto tv = g_texture_gun_side[j * TEXTURE_GUN_SIDE_WIDTH + i];
-
-                if ((tv & 0x8000) == 0)
-                    *lb = GetARGB_color(tv);
-                lb++;
-            }
-            lb += SCREEN_WIDTH - TEXTURE_GUN_SIDE_WIDTH;
-        }
+        const int sx = _width - _gunSide.width;
+        const int sy = _height - _gunSide.height + (uint8_t) offset;
+        _gunSide.Draw(fb + sy * stride + sx, stride,
+                      _gunSide.height - (uint8_t) offset);
     }
 
     // rendering aiming point
-    uint32_t *lb = fb + (SCREEN_HEIGHT / 2) * SCREEN_WIDTH + (SCREEN_WIDTH / 2);
+    uint32_t *lb = fb + (_height / 2) * stride + (_width / 2);
     for (int l = 0; l < ARM_POINT_LEN; l++) {
         float stable = (g->pose == POSE_SQUAT ? 0.2f : 1);
         uint8_t len = offset * stable + l + ARM_POINT_RAD * stable;
-        *(lb - len * SCREEN_WIDTH) = ARM_POINT_COLOR;
-        *(lb + len * SCREEN_WIDTH) = ARM_POINT_COLOR;
+        *(lb - len * stride) = ARM_POINT_COLOR;
+        *(lb + len * stride) = ARM_POINT_COLOR;
         *(lb - len) = ARM_POINT_COLOR;
         *(lb + len) = ARM_POINT_COLOR;
     }
@@ -1,39 +1,298 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <vector>
+#include "floor_caster.h"
 #include "game.h"
+#include "texture_atlas.h"
 #include "raycaster.h"
 #include "raycaster_data.h"
+#include "thread_pool.h"
 
 #define DOWN_SCALE(color) (((color) &0xFEFEFE) >> 1)
 
+// columns rendered and transposed at a time in column-major mode
+#define STRIP_COLUMNS 16
+
+// textures of the textured floor and ceiling
+#define FLOOR_TEXTURE 0
+#define CEILING_TEXTURE 0
+
+// Where a frame is seen from, in map cells and radians like the player of a
+// Game
+struct Viewpoint {
+    float x;
+    float y;
+    float a;
+};
+
 class Renderer
 {
     RayCaster *_rc;
+    const int _width;
+    const int _height;
+    const int _horizon;
+    // brightness per pixel from the horizon, 16.16, keeps the full gradient
+    // on any screen height
+    const int _shade;
+    // sky and floor color of every screen row, copied around the walls
+    std::vector<uint32_t> _background;
+
+    // Columns can be rendered column-major, where the pixels of a column are
+    // contiguous, into a strip of STRIP_COLUMNS columns per worker that is
+    // transposed into the frame while it is still in cache. See-through
+    // rendering always goes through the strips.
+    bool _columnMajor;
+    std::vector<uint32_t> _strips;
+
+    // Workers render disjoint column ranges, worker 0 with _rc and the others
+    // with their own clone of it.
+    std::unique_ptr<ThreadPool> _pool;
+    std::vector<std::unique_ptr<RayCaster>> _casters;
 
     inline static uint32_t GetARGB(uint8_t brightness)
     {
-        return (brightness << 16) + (brightness << 8) + brightness;
+        return TexelToARGB(brightness);
     }
 
-    inline static uint32_t GetARGB_color(uint16_t color)
+    inline uint32_t GetBackground(int distance) const
     {
-        return ((color & TEXTURE_R_MASK) << TEXTURE_R_OFFSET) +
-               ((color & TEXTURE_G_MASK) << TEXTURE_G_OFFSET) +
-               ((color & TEXTURE_B_MASK) << TEXTURE_B_OFFSET);
+        return GetARGB(96 + ((distance * _shade) >> 16));
     }
 
-    const uint8_t *g_texture_gray[NUMBER_OF_GRAY_TEXTURE] = {g_texture8};
+    // wall textures with their mip levels, indexed by texture number / 2
+    TextureAtlas _textures;
+    bool _mipmaps;
+    bool _texturedFloor;
+    // Billboards in view this frame, far to near. Columns are in screen
+    // pixels, texture coordinates in texels of the full size texture.
+    struct BillboardSpan {
+        int id;
+        uint32_t depth;        // 1/256 cells, as ColumnHit::depth
+        int left;              // columns [left, right)
+        int right;
+        int32_t textureX;      // texture X of column left, 16.16 texel
+        int32_t textureXStep;  // texture X step per column, 16.16 texel
+        int top;               // rows [top, top + rows)
+        int rows;
+        uint32_t textureY;     // texture Y of row top, 1/1024 texel
+        uint32_t textureStep;  // texture Y step per row, 1/1024 texel
+        const uint32_t *texels;
+        const uint32_t *masks;  // OpaqueMask of the texels
+    };
+
+    // What a frame keeps of each of its views between the phases: the view
+    // the way the casters take it, the hit of every column, the floor and
+    // ceiling, drawn a row at a time where the background would be, and the
+    // billboards in view.
+    struct View {
+        uint32_t playerX;
+        uint32_t playerY;
+        int16_t playerA;
+        ColumnHit hits;
+        FloorCaster floor;
+        std::vector<int> culled;
+        std::vector<BillboardSpan> billboards;
 
-    const uint16_t *g_texture_color[2] = {g_texture8_computer, g_texture8_cat};
+        explicit View(const RayCaster *rc);
+    };
+    // one per view of the largest batch so far, [0] for single frames
+    std::vector<std::unique_ptr<View>> _views;
+    // HUD sprites
+    const Sprite _gunSide;
+    const Sprite _gunCenter;
+
+    // A textured wall column, its texture resolved once for all its pixels.
+    // Texture coordinates are in texels of the full size texture, 1/1024
+    // texel. Pixel y of a wall sso pixels high from the horizon, showing the
+    // texture from tso, is at tso + range * y / sso with range = 32768 - tso,
+    // the truncating division stepped without dividing: the texture Y moves
+    // by range / sso per pixel, and by one more whenever the remainders of
+    // range % sso add up to sso.
+    struct WallSpan {
+        const uint32_t *texels;  // texture column of the mip level, ARGB
+        int level;               // mip level, TEXTURE_SIZE >> level texels
+        uint32_t textureY;       // texture Y of the first pixel
+        uint32_t textureStep;    // range / sso
+        uint32_t remainder;      // of the first pixel, below sso
+        uint32_t remainderStep;  // range % sso
+        uint32_t divisor;        // sso
+    };
+
+    // Fill count pixels, stride apart, with the texels of a wall column;
+    // blend darkens and mixes them into what is already there. Several
+    // pixels at a time when the CPU supports it (renderer_simd.cpp).
+    static void FillWallSpan(uint32_t *lb,
+                             int stride,
+                             int count,
+                             const WallSpan &span,
+                             bool blend);
+    // The span from `rows` pixels further down
+    static WallSpan SkipWallSpan(WallSpan span, int rows);
+    static void FillWallSpanScalar(uint32_t *lb,
+                                   int stride,
+                                   int count,
+                                   const WallSpan &span,
+                                   bool blend);
+#ifdef RAYCASTER_SIMD
+    static void FillWallSpanAVX2(uint32_t *lb,
+                                 int stride,
+                                 int count,
+                                 const WallSpan &span,
+                                 bool blend);
+#endif
+
+    // Transpose a block of columns x rows pixels from column-major src into
+    // row-major dst
+    static void Transpose(const uint32_t *src,
+                          int srcStride,
+                          uint32_t *dst,
+                          int dstStride,
+                          int columns,
+                          int rows);
+    static void TransposeScalar(const uint32_t *src,
+                                int srcStride,
+                                uint32_t *dst,
+                                int dstStride,
+                                int columns,
+                                int rows);
+#ifdef RAYCASTER_SIMD
+    static void TransposeAVX2(const uint32_t *src,
+                              int srcStride,
+                              uint32_t *dst,
+                              int dstStride,
+                              int columns,
+                              int rows);
+#endif
+
+    // Fill rows [first, last) of a column with the background and return
+    // the pixel below them
+    uint32_t *FillBackground(uint32_t *lb,
+                             int stride,
+                             int first,
+                             int last,
+                             bool blend) const;
+    // Columns are drawn through their top pixel lb and the distance between
+    // rows, so the same code fills row-major frames and column-major strips.
+    uint16_t TraceColumn(RayCaster *rc,
+                         uint32_t *lb,
+                         int stride,
+                         int x,
+                         uint16_t up,
+                         uint16_t down,
+                         uint8_t offset);
+    uint16_t RenderColumn(const ColumnHit &hits,
+                          uint32_t *lb,
+                          int stride,
+                          int x,
+                          uint16_t up,
+                          uint16_t down,
+                          uint8_t offset,
+                          bool texturedFloor = false);
+    // Draw columns [first, first + count), column x at lb + (x - first) *
+    // step; rc traces them into hits first, or NULL draws the hits already
+    // traced
+    void DrawColumns(RayCaster *rc,
+                     ColumnHit *hits,
+                     bool godMode,
+                     uint32_t *lb,
+                     int step,
+                     int stride,
+                     int first,
+                     int count);
+    // Frame buffers passed around have their rows stride pixels apart
+    void DrawFrameColumns(RayCaster *rc,
+                          ColumnHit *hits,
+                          bool godMode,
+                          uint32_t *fb,
+                          int stride,
+                          uint32_t *strip,
+                          int first,
+                          int count);
+    // Draw the floor and ceiling of columns [first, first + count) around
+    // the walls of the view, row by row
+    void DrawFloor(const View &view,
+                   uint32_t *fb,
+                   int stride,
+                   int first,
+                   int count) const;
+    // Project the billboards of the game not hidden behind every wall of
+    // the view, then draw them into columns [first, first + count) where
+    // they are nearer than the wall
+    void ProjectBillboards(const Game *g, View *view);
+    void DrawBillboards(const View &view,
+                        uint32_t *fb,
+                        int stride,
+                        int first,
+                        int count) const;
+    // Set up the first count views of _views for a frame seen from views
+    void StartViews(const Viewpoint *views, int count);
+    // Run job(caster, view, strip, first, count) on every worker, the
+    // columns of the first views of _views shared out among them as one
+    // row of views * width columns, the caster started on the view
+    void RunColumns(
+        int views,
+        const std::function<void(RayCaster *, int, uint32_t *, int, int)>
+            &job);
 
 public:
-    uint16_t RecursiveTraceFrame(uint32_t *fb,
+    uint16_t RecursiveTraceFrame(RayCaster *rc,
+                                 uint32_t *fb,
                                  int x,
                                  uint16_t up,
                                  uint16_t down,
                                  uint8_t offset);
-    void TraceFrame(Game *g, uint32_t *frameBuffer);
-    void RenderGame(Game *g, uint32_t *frameBuffer);
-    Renderer(RayCaster *rc) { _rc = rc; };
+    // Frame buffers have their rows stride pixels apart, or width pixels
+    // for a stride of 0, so that frames can be drawn straight into memory
+    // laid out by someone else, such as a locked SDL texture. Frame buffers
+    // are only written, never read: every pixel of a frame is overwritten by
+    // TraceFrame or FillFrame, and billboards and the HUD write their opaque
+    // texels over it.
+    //
+    // Draw the walls, floor and billboards of the game; see-through
+    // rendering draws no billboards
+    void TraceFrame(Game *g, uint32_t *frameBuffer, int stride = 0);
+    // TraceFrame of the game seen from count viewpoints at once, into one
+    // frame buffer each. Small frames render faster this way: the workers
+    // are woken once for all of them.
+    void TraceViews(const Game *g,
+                    const Viewpoint *views,
+                    uint32_t *const *frameBuffers,
+                    int count,
+                    int stride = 0);
+    // TraceFrame split into its two phases, without see-through rendering:
+    // trace every column into the hit buffer, then fill the columns from it
+    void TraceHits(Game *g);
+    void FillFrame(Game *g, uint32_t *frameBuffer, int stride = 0);
+    // The phases of TraceViews, without see-through rendering; FillFrames
+    // fills the frames of the views TraceHits traced last
+    void TraceHits(const Viewpoint *views, int count);
+    void FillFrames(const Game *g,
+                    uint32_t *const *frameBuffers,
+                    int count,
+                    int stride = 0);
+    // The nearest wall of every column of view `view` of the frames traced
+    // last, as the frame was drawn from them
+    const ColumnHit &Hits(int view = 0) const { return _views[view]->hits; }
+    // Draw the HUD over a frame
+    void RenderGame(Game *g, uint32_t *frameBuffer, int stride = 0);
+    void SetThreadCount(int threads);
+    // Render columns column-major into small strips first; the frame
+    // buffers passed in stay row-major
+    void SetColumnMajor(bool columnMajor);
+    bool IsColumnMajor() const { return _columnMajor; }
+    // Sample distant walls from smaller mip levels (on by default)
+    void SetMipmaps(bool mipmaps) { _mipmaps = mipmaps; }
+    bool HasMipmaps() const { return _mipmaps; }
+    // Texture the floor and ceiling instead of shading them (off by default,
+    // and always off in see-through mode)
+    void SetTexturedFloor(bool texturedFloor)
+    {
+        _texturedFloor = texturedFloor;
+    }
+    bool HasTexturedFloor() const { return _texturedFloor; }
+    int GetThreadCount() const { return _pool->Size(); }
+    Renderer(RayCaster *rc, int threads = 1);
     ~Renderer(){};
 };
@@ -0,0 +1,241 @@
+// wall span filler and column-major to row-major transpose
+//
+// Texture coordinates advance by a whole step and a remainder, giving the
+// texels of dividing per pixel without the division, and index a column of
+// the texture atlas that is already in the framebuffer format. The AVX2
+// kernel gathers 8 texels at a time from that column.
+//
+// The transpose moves 8x8 blocks through registers.
+
+#include "renderer.h"
+
+#ifdef RAYCASTER_SIMD
+#include <immintrin.h>
+#endif
+
+// texel at ty (1/1024 texel) of a mip level column
+static inline uint32_t Texel(const uint32_t *texels, uint32_t ty, int level)
+{
+    uint32_t row = ty >> (10 + level);
+    if (row > (TEXTURE_SIZE >> level) - 1u) {
+        row = (TEXTURE_SIZE >> level) - 1;
+    }
+    return texels[row];
+}
+
+Renderer::WallSpan Renderer::SkipWallSpan(WallSpan span, int rows)
+{
+    const uint32_t remainder = span.remainder + span.remainderStep * rows;
+    span.textureY += span.textureStep * rows + remainder / span.divisor;
+    span.remainder = remainder % span.divisor;
+    return span;
+}
+
+void Renderer::FillWallSpanScalar(uint32_t *lb,
+                                  int stride,
+                                  int count,
+                                  const WallSpan &span,
+                                  bool blend)
+{
+    uint32_t ty = span.textureY;
+    uint32_t remainder = span.remainder;
+    for (int y = 0; y < count; y++) {
+        const uint32_t color = Texel(span.texels, ty, span.level);
+        if (blend)
+            *lb = DOWN_SCALE(*lb) + DOWN_SCALE(color);
+        else
+            *lb = color;
+        ty += span.textureStep;
+        remainder += span.remainderStep;
+        if (remainder >= span.divisor) {
+            remainder -= span.divisor;
+            ty++;
+        }
+        lb += stride;
+    }
+}
+
+#ifdef RAYCASTER_SIMD
+
+__attribute__((target("avx2"))) void Renderer::FillWallSpanAVX2(
+    uint32_t *lb,
+    int stride,
+    int count,
+    const WallSpan &span,
+    bool blend)
+{
+    // see-through blending is rare, and cheap next to reading back
+    if (blend) {
+        FillWallSpanScalar(lb, stride, count, span, blend);
+        return;
+    }
+    // lane i starts at pixel i and every lane moves 8 pixels at a time,
+    // remainders stay below twice the divisor
+    alignas(32) uint32_t startY[8];
+    alignas(32) uint32_t startRemainder[8];
+    for (int i = 0; i < 8; i++) {
+        const WallSpan lane = SkipWallSpan(span, i);
+        startY[i] = lane.textureY;
+        startRemainder[i] = lane.remainder;
+    }
+    WallSpan from = span;
+    from.remainder = 0;
+    const WallSpan eight = SkipWallSpan(from, 8);
+    const __m256i step = _mm256_set1_epi32(eight.textureY - span.textureY);
+    const __m256i remainderStep = _mm256_set1_epi32(eight.remainder);
+    const __m256i divisor = _mm256_set1_epi32(span.divisor);
+    const __m256i lastRemainder = _mm256_set1_epi32(span.divisor - 1);
+    const __m256i lastRow =
+        _mm256_set1_epi32((TEXTURE_SIZE >> span.level) - 1);
+    const __m128i rowShift = _mm_cvtsi32_si128(10 + span.level);
+    const int *texels = reinterpret_cast<const int *>(span.texels);
+    __m256i ty =
+        _mm256_load_si256(reinterpret_cast<const __m256i *>(startY));
+    __m256i remainder =
+        _mm256_load_si256(reinterpret_cast<const __m256i *>(startRemainder));
+    alignas(32) uint32_t colors[8];
+
+    int y = 0;
+    for (; y + 8 <= count; y += 8) {
+        const __m256i row =
+            _mm256_min_epu32(_mm256_srl_epi32(ty, rowShift), lastRow);
+        const __m256i color = _mm256_i32gather_epi32(texels, row, 4);
+        ty = _mm256_add_epi32(ty, step);
+        remainder = _mm256_add_epi32(remainder, remainderStep);
+        // all ones where the remainder reached the divisor
+        const __m256i carry = _mm256_cmpgt_epi32(remainder, lastRemainder);
+        remainder = _mm256_sub_epi32(remainder,
+                                     _mm256_and_si256(carry, divisor));
+        ty = _mm256_sub_epi32(ty, carry);
+
+        if (stride == 1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(lb + y), color);
+            continue;
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i *>(colors), color);
+        uint32_t *p = lb + y * stride;
+        for (int i = 0; i < 8; i++) {
+            *p = colors[i];
+            p += stride;
+        }
+    }
+    // GCC leaves the upper halves dirty on the way to the scalar tail, which
+    // stalls SSE code running afterwards
+    _mm256_zeroupper();
+
+    if (y < count) {
+        FillWallSpanScalar(lb + y * stride, stride, count - y,
+                           SkipWallSpan(span, y), false);
+    }
+}
+
+__attribute__((target("avx2"))) void Renderer::TransposeAVX2(
+    const uint32_t *src,
+    int srcStride,
+    uint32_t *dst,
+    int dstStride,
+    int columns,
+    int rows)
+{
+    const int blockColumns = columns & ~7;
+    const int blockRows = rows & ~7;
+
+    for (int x = 0; x < blockColumns; x += 8) {
+        for (int y = 0; y < blockRows; y += 8) {
+            const uint32_t *s = src + x * srcStride + y;
+            __m256i r[8];
+            for (int i = 0; i < 8; i++) {
+                r[i] = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(s + i * srcStride));
+            }
+            // interleave pairs of columns, then pairs of pairs, then swap
+            // the 128-bit halves
+            __m256i t[8];
+            for (int i = 0; i < 8; i += 2) {
+                t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+                t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+            }
+            __m256i u[8];
+            for (int i = 0; i < 8; i += 4) {
+                u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+                u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+                u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+                u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+            }
+            uint32_t *d = dst + y * dstStride + x;
+            for (int i = 0; i < 4; i++) {
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i *>(d + i * dstStride),
+                    _mm256_permute2x128_si256(u[i], u[i + 4], 0x20));
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i *>(d + (i + 4) * dstStride),
+                    _mm256_permute2x128_si256(u[i], u[i + 4], 0x31));
+            }
+        }
+    }
+    _mm256_zeroupper();
+
+    // edges that do not fill a whole block
+    if (blockRows < rows) {
+        TransposeScalar(src + blockRows, srcStride, dst + blockRows * dstStride,
+                        dstStride, blockColumns, rows - blockRows);
+    }
+    if (blockColumns < columns) {
+        TransposeScalar(src + blockColumns * srcStride, srcStride,
+                        dst + blockColumns, dstStride, columns - blockColumns,
+                        rows);
+    }
+}
+
+#endif  // RAYCASTER_SIMD
+
+void Renderer::TransposeScalar(const uint32_t *src,
+                               int srcStride,
+                               uint32_t *dst,
+                               int dstStride,
+                               int columns,
+                               int rows)
+{
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < columns; x++) {
+            dst[y * dstStride + x] = src[x * srcStride + y];
+        }
+    }
+}
+
+void Renderer::Transpose(const uint32_t *src,
+                         int srcStride,
+                         uint32_t *dst,
+                         int dstStride,
+                         int columns,
+                         int rows)
+{
+    static const auto kernel = [] {
+#ifdef RAYCASTER_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return &Renderer::TransposeAVX2;
+        }
+#endif
+        return &Renderer::TransposeScalar;
+    }();
+    kernel(src, srcStride, dst, dstStride, columns, rows);
+}
+
+void Renderer::FillWallSpan(uint32_t *lb,
+                            int stride,
+                            int count,
+                            const WallSpan &span,
+                            bool blend)
+{
+    static const auto kernel = [] {
+#ifdef RAYCASTER_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return &Renderer::FillWallSpanAVX2;
+        }
+#endif
+        return &Renderer::FillWallSpanScalar;
+    }();
+    kernel(lb, stride, count, span, blend);
+}
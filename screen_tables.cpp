@@ -0,0 +1,67 @@
+#include "screen_tables.h"
+#include <math.h>
+#include "raycaster.h"
+#include "raycaster_tables.h"
+
+typedef ScreenLookupTables<SCREEN_WIDTH, SCREEN_HEIGHT> DefaultTables;
+
+void ScreenTables::Build(double tanHalf)
+{
+    const int overflowSize = minDist > 256 ? minDist : 256;
+    _data.resize(width + 4 * 256 + 2 * overflowSize);
+
+    uint16_t *da = &_data[0];
+    uint16_t *nh = da + width;
+    uint16_t *fh = nh + 256;
+    uint16_t *ns = fh + 256;
+    uint16_t *fs = ns + 256;
+    uint16_t *oo = fs + 256;
+    uint16_t *os = oo + overflowSize;
+
+    for (int i = 0; i < width; i++) {
+        da[i] = DeltaAngleEntry(i, width, tanHalf);
+    }
+    for (int i = 0; i < 256; i++) {
+        nh[i] = NearHeightEntry(i, minDist, invFactor);
+        fh[i] = FarHeightEntry(i, minDist, invFactor);
+        ns[i] = NearStepEntry(i, minDist, invFactor);
+        fs[i] = FarStepEntry(i, minDist, invFactor);
+    }
+    for (int i = 0; i < overflowSize; i++) {
+        oo[i] = OverflowOffsetEntry(i, height, invFactor);
+        os[i] = OverflowStepEntry(i, invFactor);
+    }
+
+    deltaAngle = da;
+    nearHeight = nh;
+    farHeight = fh;
+    nearStep = ns;
+    farStep = fs;
+    overflowOffset = oo;
+    overflowStep = os;
+}
+
+ScreenTables::ScreenTables(uint16_t width, uint16_t height, double fov)
+    : width(width), height(height)
+{
+    // the fixed field of view is defined by its exact tangent
+    tanHalf = fov == FIXED_FOV_X ? FixedFov::tanHalf : tan(fov / 2);
+    minDist = MinDistance(width, height);
+    invFactor = InvFactor(width, tanHalf);
+
+    // the default screen uses the tables compiled into the binary
+    if (width == SCREEN_WIDTH && height == SCREEN_HEIGHT &&
+        fov == FIXED_FOV_X) {
+        deltaAngle = DefaultTables::deltaAngle;
+        nearHeight = DefaultTables::nearHeight;
+        farHeight = DefaultTables::farHeight;
+        nearStep = DefaultTables::nearStep;
+        farStep = DefaultTables::farStep;
+        overflowOffset = DefaultTables::overflowOffset;
+        overflowStep = DefaultTables::overflowStep;
+        return;
+    }
+    Build(tanHalf);
+}
+
+ScreenTables::~ScreenTables() {}
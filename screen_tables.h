@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Lookup tables of the fixed-point caster that depend on the screen size and
+// field of view. The default screen uses the tables raycaster_tables.h has
+// the compiler generate, any other one gets them built on the fly.
+class ScreenTables
+{
+public:
+    uint16_t width;
+    uint16_t height;
+    // walls closer than this are taller than the screen
+    int minDist;
+    uint32_t invFactor;
+    double tanHalf;
+
+    const uint16_t *deltaAngle;      // [width]
+    const uint16_t *nearHeight;      // [256]
+    const uint16_t *farHeight;       // [256]
+    const uint16_t *nearStep;        // [256]
+    const uint16_t *farStep;         // [256]
+    const uint16_t *overflowOffset;  // [max(minDist, 256)]
+    const uint16_t *overflowStep;    // [max(minDist, 256)]
+
+    ScreenTables(uint16_t width, uint16_t height, double fov);
+    ~ScreenTables();
+
+private:
+    std::vector<uint16_t> _data;
+
+    void Build(double tanHalf);
+};
@@ -0,0 +1,134 @@
+// Checks that the walls a long-lived fixed-point caster takes from its cache
+// of ray angles are the ones a newly built caster walks to, while the view
+// turns in place, moves, and after the generation of the cache wraps around.
+
+#include <stdio.h>
+#include <random>
+#include "../raycaster_fixed.h"
+
+// The generation of the cache is private to the caster
+struct RayCasterFixedTest {
+    static void SetGeneration(RayCasterFixed *caster, uint32_t generation)
+    {
+        caster->_hitGeneration = generation;
+    }
+};
+
+struct Pose {
+    uint32_t x;
+    uint32_t y;
+    int16_t a;
+};
+
+static bool SameColumn(const ColumnHit &a, const ColumnHit &b, uint16_t x)
+{
+    return a.screenY[x] == b.screenY[x] && a.textureNo[x] == b.textureNo[x] &&
+           a.textureX[x] == b.textureX[x] && a.textureY[x] == b.textureY[x] &&
+           a.textureStep[x] == b.textureStep[x];
+}
+
+// Trace the view with the cached caster, by whole screens and column by
+// column, and with a new one, and count the columns that differ
+static int Check(const char *name, RayCasterFixed *cached, const Pose &pose)
+{
+    RayCasterFixed fresh;
+    fresh.Start(pose.x, pose.y, pose.a);
+    ColumnHit expected(SCREEN_WIDTH);
+    fresh.TraceColumns(0, SCREEN_WIDTH, &expected);
+
+    cached->Start(pose.x, pose.y, pose.a);
+    ColumnHit columns(SCREEN_WIDTH);
+    cached->TraceColumns(0, SCREEN_WIDTH, &columns);
+    ColumnHit traced(SCREEN_WIDTH);
+    for (uint16_t x = 0; x < SCREEN_WIDTH; x++) {
+        cached->Trace(x, &traced.screenY[x], &traced.textureNo[x],
+                      &traced.textureX[x], &traced.textureY[x],
+                      &traced.textureStep[x]);
+    }
+
+    int failures = 0;
+    for (uint16_t x = 0; x < SCREEN_WIDTH; x++) {
+        const bool sameDepth = columns.depth[x] == expected.depth[x];
+        const bool sameColumns = SameColumn(columns, expected, x);
+        const bool sameTraced = SameColumn(traced, expected, x);
+        if (sameDepth && sameColumns && sameTraced) {
+            continue;
+        }
+        if (failures++ < 10) {
+            fprintf(stderr,
+                    "%s: column %d at (0x%x, 0x%x, %d) differs from a new "
+                    "caster in%s%s%s\n",
+                    name, x, pose.x, pose.y, pose.a,
+                    sameDepth ? "" : " depth", sameColumns ? "" : " columns",
+                    sameTraced ? "" : " trace");
+        }
+    }
+    return failures;
+}
+
+static Pose RandomPose(std::mt19937 &random)
+{
+    std::uniform_int_distribution<uint32_t> x(256, (MAP_X - 1) * 256 - 1);
+    std::uniform_int_distribution<uint32_t> y(256, (MAP_Y - 1) * 256 - 1);
+    std::uniform_int_distribution<int> a(0, FIXED_ANGLES - 1);
+    return {x(random), y(random), static_cast<int16_t>(a(random))};
+}
+
+int main()
+{
+    std::mt19937 random(1);
+    int failures = 0;
+
+    // turning in place, every ray of the circle comes from the cache
+    // several times over
+    RayCasterFixed turning;
+    for (const Pose &start : {RandomPose(random), RandomPose(random)}) {
+        for (int a = 0; a < 3 * FIXED_ANGLES; a += 7) {
+            const Pose pose = {start.x, start.y,
+                               static_cast<int16_t>(a % FIXED_ANGLES)};
+            failures += Check("rotation", &turning, pose);
+        }
+    }
+
+    // moving, by a single unit as well as across the map, and back to where
+    // the view was before
+    RayCasterFixed moving;
+    std::uniform_int_distribution<int> step(-1, 1);
+    Pose pose = RandomPose(random);
+    for (int i = 0; i < 300; i++) {
+        const Pose previous = pose;
+        if (i % 10 == 9) {
+            pose = RandomPose(random);
+        } else {
+            pose.x += step(random);
+            pose.y += step(random);
+            pose.a = static_cast<int16_t>((pose.a + step(random) * 3) &
+                                          (FIXED_ANGLES - 1));
+        }
+        failures += Check("position", &moving, pose);
+        if (i % 20 == 19) {
+            failures += Check("position", &moving, previous);
+        }
+    }
+
+    // The rays of the first view are cached in the second generation. The
+    // next move wraps the generation around and only caches the rays of the
+    // opposite view, so the move after it is in the second generation again:
+    // turning back there would show the first walls if the wraparound left
+    // them in the cache.
+    RayCasterFixed wrapping;
+    const Pose first = {0x500, 0x500, 0};
+    const Pose opposite = {0x600, 0x500, FIXED_ANGLES / 2};
+    const Pose turned = {0x700, 0x500, 0};
+    failures += Check("wraparound", &wrapping, first);
+    RayCasterFixedTest::SetGeneration(&wrapping, UINT32_MAX);
+    failures += Check("wraparound", &wrapping, opposite);
+    failures += Check("wraparound", &wrapping, turned);
+
+    if (failures > 0) {
+        fprintf(stderr, "angle_cache_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("angle_cache_test: ok\n");
+    return 0;
+}
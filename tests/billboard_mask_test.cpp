@@ -0,0 +1,75 @@
+// Checks which wall texels billboards draw: only black, every channel below
+// 0x28, is transparent, whatever the other channels hold.
+
+#include <stdio.h>
+#include <vector>
+#include "../mipmap.h"
+#include "../texture_atlas.h"
+
+struct Case {
+    uint16_t texel;
+    bool opaque;
+    const char *name;
+};
+
+// 5-bit channels, widened to 8 bits by TexelToARGB
+static const Case colorCases[] = {
+    {0x7FFF, true, "white"},
+    {0x7C00, true, "red"},
+    {0x03E0, true, "green"},
+    {0x001F, true, "blue"},
+    {0x7FE0, true, "yellow"},
+    {0x03FF, true, "cyan"},
+    {0x7C1F, true, "magenta"},
+    {0x7C05, true, "red, dim blue"},
+    {0x0005, true, "blue at 0x28"},
+    {0x1084, false, "channels at 0x20"},
+    {0x0000, false, "black"},
+};
+
+static const Case grayCases[] = {
+    {0xFF, true, "white"},
+    {0x28, true, "gray 0x28"},
+    {0x27, false, "gray 0x27"},
+    {0x00, false, "black"},
+};
+
+// Lay the cases out down the first column of a texture, add it to an atlas
+// and compare the masks of that column with the expected opacity
+template <typename Texel>
+static int Check(const char *kind, const Case *cases, int count)
+{
+    std::vector<Texel> texture(TEXTURE_SIZE * TEXTURE_SIZE);
+    for (int i = 0; i < count; i++) {
+        texture[i * TEXTURE_SIZE] = static_cast<Texel>(cases[i].texel);
+    }
+    TextureAtlas atlas;
+    const int index = atlas.Add(MipChain<Texel>(texture.data()));
+    const uint32_t *masks = atlas.Masks(index, 0, 0);
+
+    int failures = 0;
+    for (int i = 0; i < count; i++) {
+        const uint32_t expected = cases[i].opaque ? 0xFFFFFFFF : 0;
+        if (masks[i] != expected) {
+            fprintf(stderr, "%s %s (0x%04x): mask 0x%08x, expected 0x%08x\n",
+                    kind, cases[i].name, cases[i].texel, masks[i], expected);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main()
+{
+    const int failures =
+        Check<uint16_t>("color", colorCases,
+                        sizeof(colorCases) / sizeof(colorCases[0])) +
+        Check<uint8_t>("gray", grayCases,
+                       sizeof(grayCases) / sizeof(grayCases[0]));
+    if (failures > 0) {
+        fprintf(stderr, "billboard_mask_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("billboard_mask_test: ok\n");
+    return 0;
+}
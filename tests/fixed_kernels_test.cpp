@@ -0,0 +1,186 @@
+// Checks that the AVX2 and AVX-512 walks of the fixed-point caster find the
+// same walls as the scalar one, for random rays on maps of several shapes.
+// Kernels the CPU lacks are skipped.
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+#include "../raycaster_fixed.h"
+
+#define RAYS_PER_MAP 200000
+#define MAX_BATCH 256
+
+struct Walls {
+    int32_t deltaX[MAX_BATCH];
+    int32_t deltaY[MAX_BATCH];
+    uint8_t textureNo[MAX_BATCH];
+    uint8_t textureX[MAX_BATCH];
+};
+
+struct Kernel {
+    const char *name;
+    void (*walk)(const Map &map,
+                 uint32_t rayX,
+                 uint32_t rayY,
+                 const uint16_t *rayA,
+                 int count,
+                 Walls *walls);
+};
+
+// The kernels are private to the caster
+struct RayCasterFixedTest {
+    static void Single(const Map &map,
+                       uint32_t rayX,
+                       uint32_t rayY,
+                       const uint16_t *rayA,
+                       int count,
+                       Walls *walls)
+    {
+        for (int i = 0; i < count; i++) {
+            RayCasterFixed::CalculateDistance(
+                map, rayX, rayY, rayA[i], &walls->deltaX[i],
+                &walls->deltaY[i], &walls->textureNo[i], &walls->textureX[i]);
+        }
+    }
+
+    static void Scalar(const Map &map,
+                       uint32_t rayX,
+                       uint32_t rayY,
+                       const uint16_t *rayA,
+                       int count,
+                       Walls *walls)
+    {
+        RayCasterFixed::CalculateDistancesScalar(
+            map, rayX, rayY, rayA, count, walls->deltaX, walls->deltaY,
+            walls->textureNo, walls->textureX);
+    }
+
+#ifdef RAYCASTER_SIMD
+    static void AVX2(const Map &map,
+                     uint32_t rayX,
+                     uint32_t rayY,
+                     const uint16_t *rayA,
+                     int count,
+                     Walls *walls)
+    {
+        RayCasterFixed::CalculateDistancesAVX2(
+            map, rayX, rayY, rayA, count, walls->deltaX, walls->deltaY,
+            walls->textureNo, walls->textureX);
+    }
+
+    static void AVX512(const Map &map,
+                       uint32_t rayX,
+                       uint32_t rayY,
+                       const uint16_t *rayA,
+                       int count,
+                       Walls *walls)
+    {
+        RayCasterFixed::CalculateDistancesAVX512(
+            map, rayX, rayY, rayA, count, walls->deltaX, walls->deltaY,
+            walls->textureNo, walls->textureX);
+    }
+#endif
+};
+
+// Cells of a width by height map, each a wall of a random texture with the
+// given probability
+static std::vector<uint8_t> RandomCells(std::mt19937 &random,
+                                        int width,
+                                        int height,
+                                        double density)
+{
+    std::bernoulli_distribution wall(density);
+    std::uniform_int_distribution<int> texture(1, 4);
+    std::vector<uint8_t> cells(width * height);
+    for (auto &cell : cells) {
+        cell = wall(random) ? texture(random) : 0;
+    }
+    return cells;
+}
+
+// Walk batches of random rays from random positions, some of them just
+// outside the map, with every kernel and compare them with the scalar walk
+static int Check(const char *name,
+                 const Map &map,
+                 const std::vector<Kernel> &kernels,
+                 std::mt19937 &random)
+{
+    std::uniform_int_distribution<uint32_t> rayX(0, map.Width() * 256 + 511);
+    std::uniform_int_distribution<uint32_t> rayY(0, map.Height() * 256 + 511);
+    std::uniform_int_distribution<int> angle(0, FIXED_ANGLES - 1);
+    std::uniform_int_distribution<int> batch(1, MAX_BATCH);
+    uint16_t rayA[MAX_BATCH];
+    Walls expected;
+    Walls walls;
+
+    int failures = 0;
+    for (int rays = 0; rays < RAYS_PER_MAP;) {
+        const uint32_t x = rayX(random);
+        const uint32_t y = rayY(random);
+        const int count = batch(random);
+        for (int i = 0; i < count; i++) {
+            rayA[i] = static_cast<uint16_t>(angle(random));
+        }
+        RayCasterFixedTest::Scalar(map, x, y, rayA, count, &expected);
+        for (const Kernel &kernel : kernels) {
+            kernel.walk(map, x, y, rayA, count, &walls);
+            for (int i = 0; i < count; i++) {
+                if (walls.deltaX[i] == expected.deltaX[i] &&
+                    walls.deltaY[i] == expected.deltaY[i] &&
+                    walls.textureNo[i] == expected.textureNo[i] &&
+                    walls.textureX[i] == expected.textureX[i]) {
+                    continue;
+                }
+                if (failures++ < 10) {
+                    fprintf(stderr,
+                            "%s %s: ray %d from (0x%x, 0x%x): "
+                            "(%d, %d, %d, %d), expected (%d, %d, %d, %d)\n",
+                            name, kernel.name, rayA[i], x, y, walls.deltaX[i],
+                            walls.deltaY[i], walls.textureNo[i],
+                            walls.textureX[i], expected.deltaX[i],
+                            expected.deltaY[i], expected.textureNo[i],
+                            expected.textureX[i]);
+                }
+            }
+        }
+        rays += count;
+    }
+    return failures;
+}
+
+int main()
+{
+    std::vector<Kernel> kernels = {{"single", RayCasterFixedTest::Single}};
+#ifdef RAYCASTER_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back({"avx2", RayCasterFixedTest::AVX2});
+    } else {
+        printf("fixed_kernels_test: no AVX2, skipped\n");
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.push_back({"avx512", RayCasterFixedTest::AVX512});
+    } else {
+        printf("fixed_kernels_test: no AVX-512, skipped\n");
+    }
+#endif
+
+    std::mt19937 random(1);
+    // Neither side a multiple of the 8 cells of a block
+    const Map odd(37, 13, RandomCells(random, 37, 13, 0.2), 1.5f, 1.5f, 0.0f);
+    // Large enough for the walk over empty blocks (BLOCK_WALK_MIN_CELLS),
+    // with walls sparse enough to leave most blocks empty
+    const Map large(MAP_MAX_SIZE, MAP_MAX_SIZE / 2,
+                    RandomCells(random, MAP_MAX_SIZE, MAP_MAX_SIZE / 2, 2e-3),
+                    1.5f, 1.5f, 0.0f);
+
+    const int failures = Check("default", Map::Default(), kernels, random) +
+                         Check("37x13", odd, kernels, random) +
+                         Check("large", large, kernels, random);
+    if (failures > 0) {
+        fprintf(stderr, "fixed_kernels_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("fixed_kernels_test: ok\n");
+    return 0;
+}
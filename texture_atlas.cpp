@@ -0,0 +1,68 @@
+#include "texture_atlas.h"
+#include <string.h>
+
+TextureAtlas::TextureAtlas() : _textureSize(0)
+{
+    for (int level = 0; level < MIP_LEVELS; level++) {
+        _levelOffsets[level] = _textureSize;
+        _textureSize += (TEXTURE_SIZE >> level) * (TEXTURE_SIZE >> level);
+    }
+}
+
+template <typename Texel>
+int TextureAtlas::Add(const MipChain<Texel> &chain)
+{
+    const int index = Size();
+    _texels.resize(_texels.size() + _textureSize);
+    _masks.resize(_texels.size());
+
+    for (int level = 0; level < MIP_LEVELS; level++) {
+        const int width = TEXTURE_SIZE >> level;
+        const Texel *src = chain.Level(level);
+        const int offset = index * _textureSize + _levelOffsets[level];
+        uint32_t *dst = &_texels[offset];
+        uint32_t *mask = &_masks[offset];
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < width; y++) {
+                *dst = TexelToARGB(src[y * width + x]);
+                *mask++ = OpaqueMask(*dst++);
+            }
+        }
+    }
+    return index;
+}
+
+template int TextureAtlas::Add(const MipChain<uint8_t> &chain);
+template int TextureAtlas::Add(const MipChain<uint16_t> &chain);
+
+Sprite::Sprite(const uint16_t *texels, int width, int height)
+    : width(width), height(height), _pixels(width * height)
+{
+    for (int j = 0; j < height; j++) {
+        const uint16_t *row = texels + j * width;
+        for (int i = 0; i < width;) {
+            if ((row[i] & 0x8000) != 0) {
+                i++;
+                continue;
+            }
+            Run run = {j, i, 0};
+            for (; i < width && (row[i] & 0x8000) == 0; i++) {
+                _pixels[j * width + i] = TexelToARGB(row[i]);
+                run.count++;
+            }
+            _runs.push_back(run);
+        }
+    }
+}
+
+void Sprite::Draw(uint32_t *lb, int stride, int rows) const
+{
+    for (const Run &run : _runs) {
+        if (run.row >= rows) {
+            break;
+        }
+        memcpy(lb + run.row * stride + run.first,
+               &_pixels[run.row * width + run.first],
+               run.count * sizeof(uint32_t));
+    }
+}
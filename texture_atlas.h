@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "mipmap.h"
+#include "raycaster.h"
+
+// Framebuffer color of a gray scale texel
+inline uint32_t TexelToARGB(uint8_t brightness)
+{
+    return (brightness << 16) + (brightness << 8) + brightness;
+}
+
+// Framebuffer color of a 5-bit per channel texel
+inline uint32_t TexelToARGB(uint16_t color)
+{
+    return ((color & TEXTURE_R_MASK) << TEXTURE_R_OFFSET) +
+           ((color & TEXTURE_G_MASK) << TEXTURE_G_OFFSET) +
+           ((color & TEXTURE_B_MASK) << TEXTURE_B_OFFSET);
+}
+
+// Opacity mask of a framebuffer color drawn as a billboard texel: black,
+// every channel below 0x28, is transparent
+inline uint32_t OpaqueMask(uint32_t color)
+{
+    return (color & 0xFF) >= 0x28 || ((color >> 8) & 0xFF) >= 0x28 ||
+                   ((color >> 16) & 0xFF) >= 0x28
+               ? 0xFFFFFFFF
+               : 0;
+}
+
+// All wall textures and their mip levels in one buffer, converted to the
+// framebuffer format once. Texels are stored column by column, so drawing a
+// wall column reads one contiguous run of the atlas. Every texel has an
+// opacity mask laid out the same way, for drawing the textures as
+// billboards.
+class TextureAtlas
+{
+public:
+    // Add a texture with all its mip levels, returns its index
+    template <typename Texel>
+    int Add(const MipChain<Texel> &chain);
+
+    // Column textureX of a texture, in texels of the full size texture; the
+    // column of mip level `level` holds TEXTURE_SIZE >> level texels
+    const uint32_t *Column(int texture, int level, int textureX) const
+    {
+        return &_texels[texture * _textureSize + _levelOffsets[level] +
+                        (textureX >> level) * (TEXTURE_SIZE >> level)];
+    }
+    // OpaqueMask of the texels of Column
+    const uint32_t *Masks(int texture, int level, int textureX) const
+    {
+        return &_masks[texture * _textureSize + _levelOffsets[level] +
+                       (textureX >> level) * (TEXTURE_SIZE >> level)];
+    }
+    int Size() const { return static_cast<int>(_texels.size()) / _textureSize; }
+
+    TextureAtlas();
+
+private:
+    std::vector<uint32_t> _texels;
+    std::vector<uint32_t> _masks;
+    int _levelOffsets[MIP_LEVELS];
+    int _textureSize;  // texels of a texture with all its levels
+};
+
+// A sprite converted to the framebuffer format once. Texels with the
+// transparency bit 0x8000 set are left out, the others are kept as runs of
+// opaque texels per row, so drawing copies the runs and writes the frame
+// buffer without reading it.
+class Sprite
+{
+public:
+    const int width;
+    const int height;
+
+    // Draw rows [0, rows) of the sprite with its top left pixel at lb, into
+    // a frame buffer `stride` pixels wide
+    void Draw(uint32_t *lb, int stride, int rows) const;
+
+    Sprite(const uint16_t *texels, int width, int height);
+
+private:
+    // Opaque texels [first, first + count) of a row
+    struct Run {
+        int row;
+        int first;
+        int count;
+    };
+
+    std::vector<uint32_t> _pixels;
+    std::vector<Run> _runs;  // top to bottom
+};
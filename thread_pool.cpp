@@ -0,0 +1,68 @@
+#include "thread_pool.h"
+
+void ThreadPool::Work(int index)
+{
+    unsigned generation = 0;
+    for (;;) {
+        const std::function<void(int)> *job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&] {
+                return _exiting || _generation != generation;
+            });
+            if (_exiting) {
+                return;
+            }
+            generation = _generation;
+            job = _job;
+        }
+
+        (*job)(index);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_pending == 0) {
+            _done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::Run(const std::function<void(int)> &job)
+{
+    if (_threads.empty()) {
+        job(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &job;
+        _pending = static_cast<int>(_threads.size());
+        _generation++;
+    }
+    _wake.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [&] { return _pending == 0; });
+}
+
+ThreadPool::ThreadPool(int threads)
+    : _job(nullptr), _generation(0), _pending(0), _exiting(false)
+{
+    for (int i = 1; i < threads; i++) {
+        _threads.emplace_back(&ThreadPool::Work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _exiting = true;
+    }
+    _wake.notify_all();
+    for (auto &t : _threads) {
+        t.join();
+    }
+}
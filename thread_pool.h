@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of worker threads running the same job on every worker.
+// The calling thread takes part as worker 0, so a pool of one thread spawns
+// nothing and runs the job inline.
+class ThreadPool
+{
+public:
+    // Run job(index) on every worker and wait until all of them returned
+    void Run(const std::function<void(int)> &job);
+    int Size() const { return static_cast<int>(_threads.size()) + 1; }
+
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+private:
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(int)> *_job;
+    unsigned _generation;
+    int _pending;
+    bool _exiting;
+
+    void Work(int index);
+};
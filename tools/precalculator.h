@@ -1,10 +0,0 @@
-#pragma once
-
-class RayCasterPrecalculator
-{
-public:
-    RayCasterPrecalculator();
-    ~RayCasterPrecalculator();
-
-    static void Precalculate();
-};